@@ -124,9 +124,9 @@
             };
 
             powerMode = lib.mkOption {
-              type = lib.types.enum [ "full" "throttled" "paused" ];
+              type = lib.types.enum [ "full" "throttled" "paused" "deep-paused" ];
               default = "full";
-              description = "Rendering power policy: full, throttled, or paused when occluded.";
+              description = "Rendering power policy: full, throttled, paused, or deep-paused when occluded.";
             };
 
             mouseOverlay = lib.mkOption {
@@ -83,7 +83,7 @@ in
     };
 
     powerMode = lib.mkOption {
-      type = lib.types.enum [ "full" "throttled" "paused" ];
+      type = lib.types.enum [ "full" "throttled" "paused" "deep-paused" ];
       default = "full";
       description = "Rendering power policy";
     };
@@ -0,0 +1,32 @@
+// --vertex-shader particles.vert --allow-vertex-shaders --particle-state
+// State: xy is position, zw is velocity.
+uniform float iTimeDelta;
+
+float hash(float n)
+{
+  return fract(sin(n * 12.9898) * 43758.5453);
+}
+
+vec4 spawn(float seed)
+{
+  float angle = 1.2 + 0.7 * hash(seed);
+  float speed = 0.8 + 0.6 * hash(seed + 1.0);
+  return vec4(-0.9, -1.0, cos(angle) * speed, sin(angle) * speed);
+}
+
+void main ()
+{
+  vec4 p = particleState;
+  float dt = min(iTimeDelta, 0.05);
+
+  if ((p.z == 0.0 && p.w == 0.0) || p.y < -1.05)
+    p = spawn(vertexId + floor(p.x * 1000.0));
+
+  p.w -= 1.5 * dt;
+  p.xy += p.zw * dt;
+  nextParticleState = p;
+
+  gl_Position = vec4(p.xy, 0.0, 1.0);
+  gl_PointSize = 2.0;
+  v_color = vec4(0.4 + 0.6 * hash(vertexId), 0.6, 1.0, 0.8);
+}
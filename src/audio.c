@@ -4,6 +4,9 @@
 #include <assert.h>
 
 #include "audio.h"
+#include "gl_alloc.h"
+#include "replay.h"
+#include "trace.h"
 #include "utils.h"
 
 #include <pulse/context.h>
@@ -20,16 +23,18 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
-#define GLWALL_AUDIO_TEX_WIDTH 512
-#define GLWALL_AUDIO_TEX_HEIGHT 2
 #define GLWALL_AUDIO_TEX_ROW_WAVEFORM 0
 #define GLWALL_AUDIO_TEX_ROW_SPECTRUM 1
 #define GLWALL_AUDIO_NORMALIZATION 32768.0f
 #define GLWALL_FFT_SIZE 512
 
+_Static_assert(GLWALL_FFT_SIZE == GLWALL_TRACE_AUDIO_SAMPLES,
+               "recordings store one FFT block per frame");
+
 struct glwall_audio_impl {
     pa_simple *pa;
     bool is_fake;
+    bool is_replay;
     float phase;
 
     pthread_t thread;
@@ -39,6 +44,8 @@ struct glwall_audio_impl {
     size_t write_idx;
     size_t frames_available;
     bool thread_running;
+    uint64_t latency_us;
+    struct timespec last_read;
 };
 
 struct pa_monitor_data {
@@ -128,7 +135,12 @@ static void *audio_capture_thread(void *arg) {
             ai->thread_running = false;
             break;
         }
+        pa_usec_t latency = pa_simple_get_latency(ai->pa, &error);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
         pthread_mutex_lock(&ai->lock);
+        ai->latency_us = latency != (pa_usec_t)-1 ? latency : 0;
+        ai->last_read = now;
         for (int i = 0; i < GLWALL_FFT_SIZE; ++i) {
             ai->ring[ai->write_idx] = samples[i];
             ai->write_idx = (ai->write_idx + 1) % ai->ring_len;
@@ -142,12 +154,45 @@ static void *audio_capture_thread(void *arg) {
     return NULL;
 }
 
+GLuint audio_create_texture(struct glwall_state *state, uint32_t owner) {
+    GLuint tex = 0;
+#ifndef UNIT_TEST
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_RED};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
+
+    gl_alloc_tex_image_2d(&state->gpu_mem, GLWALL_GPU_MEM_AUDIO, owner, tex, GL_R32F,
+                          GLWALL_AUDIO_TEX_WIDTH, GLWALL_AUDIO_TEX_HEIGHT, GL_RED, GL_FLOAT, NULL);
+#else
+    (void)state;
+    (void)owner;
+#endif
+    return tex;
+}
+
+void audio_upload_texels(GLuint texture, const float *texels) {
+#ifndef UNIT_TEST
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLWALL_AUDIO_TEX_WIDTH, GLWALL_AUDIO_TEX_HEIGHT, GL_RED,
+                    GL_FLOAT, texels);
+#else
+    (void)texture;
+    (void)texels;
+#endif
+}
+
 static void glwall_audio_reset(struct glwall_state *state) {
     state->audio.enabled = false;
     state->audio.backend_ready = false;
     if (state->audio.texture != 0) {
 #ifndef UNIT_TEST
-        glDeleteTextures(1, &state->audio.texture);
+        gl_alloc_delete_textures(&state->gpu_mem, 1, &state->audio.texture);
         state->audio.texture = 0;
 #else
         state->audio.texture = 0;
@@ -184,9 +229,10 @@ bool init_audio(struct glwall_state *state) {
         return true;
     }
 
-    if (state->audio_source == GLWALL_AUDIO_SOURCE_FAKE) {
-        LOG_INFO("%s",
-                 "Audio subsystem initialization: fake audio backend selected for diagnostics");
+    if (state->audio_source == GLWALL_AUDIO_SOURCE_FAKE ||
+        state->audio_source == GLWALL_AUDIO_SOURCE_REPLAY) {
+        LOG_INFO("Audio subsystem initialization: %s audio backend selected",
+                 state->audio_source == GLWALL_AUDIO_SOURCE_REPLAY ? "replay" : "fake");
 
         struct glwall_audio_impl *impl = calloc(1, sizeof(struct glwall_audio_impl));
         if (!impl) {
@@ -196,6 +242,7 @@ bool init_audio(struct glwall_state *state) {
             return false;
         }
         impl->is_fake = true;
+        impl->is_replay = state->audio_source == GLWALL_AUDIO_SOURCE_REPLAY;
         impl->phase = 0.0f;
         impl->pa = NULL;
         impl->ring_len = GLWALL_FFT_SIZE * 8;
@@ -206,42 +253,21 @@ bool init_audio(struct glwall_state *state) {
         pthread_mutex_init(&impl->lock, NULL);
         state->audio.impl = impl;
 
-        GLuint tex = 0;
-#ifndef UNIT_TEST
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_RED};
-        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
-
         state->audio.tex_width_px = GLWALL_AUDIO_TEX_WIDTH;
         state->audio.tex_height_px = GLWALL_AUDIO_TEX_HEIGHT;
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, state->audio.tex_width_px,
-                     state->audio.tex_height_px, 0, GL_RED, GL_FLOAT, NULL);
-
-        state->audio.texture = tex;
-#else
-        state->audio.tex_width_px = GLWALL_AUDIO_TEX_WIDTH;
-        state->audio.tex_height_px = GLWALL_AUDIO_TEX_HEIGHT;
-        state->audio.texture = 0;
-#endif
+        state->audio.texture = audio_create_texture(state, GLWALL_GPU_MEM_SHARED);
         state->audio.enabled = true;
         state->audio.backend_ready = true;
 
         LOG_INFO("Audio resource created: texture (%dx%d) initialized for fake audio backend",
                  state->audio.tex_width_px, state->audio.tex_height_px);
 #ifndef UNIT_TEST
-        if (state->shader_program && state->loc_sound_res != -1) {
-            if (state->current_program != state->shader_program) {
-                glUseProgram(state->shader_program);
-                state->current_program = state->shader_program;
+        if (state->user_program.program && state->user_program.loc_sound_res != -1) {
+            if (state->current_program != state->user_program.program) {
+                glUseProgram(state->user_program.program);
+                state->current_program = state->user_program.program;
             }
-            glUniform2f(state->loc_sound_res, (float)state->audio.tex_width_px,
+            glUniform2f(state->user_program.loc_sound_res, (float)state->audio.tex_width_px,
                         (float)state->audio.tex_height_px);
             glUseProgram(0);
             state->current_program = 0;
@@ -330,30 +356,9 @@ bool init_audio(struct glwall_state *state) {
     }
     state->audio.impl = impl;
 
-    GLuint tex = 0;
-#ifndef UNIT_TEST
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_RED};
-    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
-
-    state->audio.tex_width_px = GLWALL_AUDIO_TEX_WIDTH;
-    state->audio.tex_height_px = GLWALL_AUDIO_TEX_HEIGHT;
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, state->audio.tex_width_px, state->audio.tex_height_px,
-                 0, GL_RED, GL_FLOAT, NULL);
-
-    state->audio.texture = tex;
-#else
     state->audio.tex_width_px = GLWALL_AUDIO_TEX_WIDTH;
     state->audio.tex_height_px = GLWALL_AUDIO_TEX_HEIGHT;
-    state->audio.texture = 0;
-#endif
+    state->audio.texture = audio_create_texture(state, GLWALL_GPU_MEM_SHARED);
     state->audio.enabled = true;
     state->audio.backend_ready = true;
 
@@ -361,12 +366,12 @@ bool init_audio(struct glwall_state *state) {
              state->audio.tex_width_px, state->audio.tex_height_px);
     LOG_DEBUG(state, "%s", "Audio subsystem initialization completed successfully");
 #ifndef UNIT_TEST
-    if (state->shader_program && state->loc_sound_res != -1) {
-        if (state->current_program != state->shader_program) {
-            glUseProgram(state->shader_program);
-            state->current_program = state->shader_program;
+    if (state->user_program.program && state->user_program.loc_sound_res != -1) {
+        if (state->current_program != state->user_program.program) {
+            glUseProgram(state->user_program.program);
+            state->current_program = state->user_program.program;
         }
-        glUniform2f(state->loc_sound_res, (float)state->audio.tex_width_px,
+        glUniform2f(state->user_program.loc_sound_res, (float)state->audio.tex_width_px,
                     (float)state->audio.tex_height_px);
         glUseProgram(0);
         state->current_program = 0;
@@ -465,34 +470,39 @@ static void generate_fake_audio(struct glwall_audio_impl *impl, int16_t *samples
     }
 }
 
-void update_audio_texture(struct glwall_state *state) {
+bool audio_compute_texels(struct glwall_state *state, float *texels) {
     assert(state != NULL);
 
     if (!state->audio.enabled || !state->audio.backend_ready)
-        return;
+        return false;
     if (!state->audio.impl)
-        return;
+        return false;
 
     struct glwall_audio_impl *impl = state->audio.impl;
 
     if (impl->is_fake) {
 
     } else if (!impl->pa) {
-        return;
+        return false;
     }
 
     int width = state->audio.tex_width_px;
     int height = state->audio.tex_height_px;
     if (width <= 0 || height <= 0 || state->audio.texture == 0)
-        return;
+        return false;
 
     int16_t samples[GLWALL_FFT_SIZE];
 
-    if (impl->is_fake) {
+    if (impl->is_replay) {
+#ifndef UNIT_TEST
+        if (!replay_audio_block(state, samples))
+#endif
+            memset(samples, 0, sizeof(samples));
+    } else if (impl->is_fake) {
         generate_fake_audio(impl, samples, GLWALL_FFT_SIZE);
     } else {
         if (!impl->pa) {
-            return;
+            return false;
         }
 
         pthread_mutex_lock(&impl->lock);
@@ -515,6 +525,9 @@ void update_audio_texture(struct glwall_state *state) {
         }
         pthread_mutex_unlock(&impl->lock);
     }
+#ifndef UNIT_TEST
+    record_audio_block(state, samples);
+#endif
 
     static FILE *debug_file = NULL;
     static int frame_count = 0;
@@ -597,24 +610,23 @@ void update_audio_texture(struct glwall_state *state) {
         spectrum_row[i] = normalized;
     }
 
-    float audio_texture[GLWALL_AUDIO_TEX_WIDTH * GLWALL_AUDIO_TEX_HEIGHT];
-    memcpy(audio_texture + (size_t)GLWALL_AUDIO_TEX_ROW_WAVEFORM * GLWALL_AUDIO_TEX_WIDTH,
-           waveform_row, sizeof(waveform_row));
-    memcpy(audio_texture + (size_t)GLWALL_AUDIO_TEX_ROW_SPECTRUM * GLWALL_AUDIO_TEX_WIDTH,
-           spectrum_row, sizeof(spectrum_row));
-
-#ifndef UNIT_TEST
-    glBindTexture(GL_TEXTURE_2D, state->audio.texture);
-#endif
-
     if (width != GLWALL_AUDIO_TEX_WIDTH || height != GLWALL_AUDIO_TEX_HEIGHT) {
         LOG_WARN("Audio subsystem: unexpected texture size (%dx%d), expected %dx%d", width, height,
                  GLWALL_AUDIO_TEX_WIDTH, GLWALL_AUDIO_TEX_HEIGHT);
+        return false;
     }
 
-#ifndef UNIT_TEST
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_FLOAT, audio_texture);
-#endif
+    memcpy(texels + (size_t)GLWALL_AUDIO_TEX_ROW_WAVEFORM * GLWALL_AUDIO_TEX_WIDTH, waveform_row,
+           sizeof(waveform_row));
+    memcpy(texels + (size_t)GLWALL_AUDIO_TEX_ROW_SPECTRUM * GLWALL_AUDIO_TEX_WIDTH, spectrum_row,
+           sizeof(spectrum_row));
+    return true;
+}
+
+void update_audio_texture(struct glwall_state *state) {
+    float texels[GLWALL_AUDIO_TEXELS];
+    if (audio_compute_texels(state, texels))
+        audio_upload_texels(state->audio.texture, texels);
 }
 
 void cleanup_audio(struct glwall_state *state) { glwall_audio_reset(state); }
@@ -642,6 +654,24 @@ int audio_read_recent_samples(struct glwall_state *state, int16_t *out, size_t c
     return (int)take;
 }
 
+bool audio_latency_ms(struct glwall_state *state, double *latency_ms) {
+    if (!state || !state->audio.impl || !latency_ms)
+        return false;
+    struct glwall_audio_impl *impl = state->audio.impl;
+    if (impl->is_fake || !impl->thread_running)
+        return false;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&impl->lock);
+    bool valid = impl->last_read.tv_sec != 0 || impl->last_read.tv_nsec != 0;
+    double age_ms = (double)(now.tv_sec - impl->last_read.tv_sec) * 1000.0 +
+                    (double)(now.tv_nsec - impl->last_read.tv_nsec) / 1e6;
+    *latency_ms = (double)impl->latency_us / 1000.0 + age_ms;
+    pthread_mutex_unlock(&impl->lock);
+    return valid;
+}
+
 void audio_test_overwrite_ring(struct glwall_state *state, const int16_t *samples, size_t count) {
     if (!state || !state->audio.impl || !samples)
         return;
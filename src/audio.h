@@ -4,13 +4,25 @@
 
 #include <complex.h>
 
+#define GLWALL_AUDIO_TEX_WIDTH 512
+#define GLWALL_AUDIO_TEX_HEIGHT 2
+#define GLWALL_AUDIO_TEXELS (GLWALL_AUDIO_TEX_WIDTH * GLWALL_AUDIO_TEX_HEIGHT)
+
 bool init_audio(struct glwall_state *state);
 
 void update_audio_texture(struct glwall_state *state);
 
+bool audio_compute_texels(struct glwall_state *state, float *texels);
+
+void audio_upload_texels(GLuint texture, const float *texels);
+
+GLuint audio_create_texture(struct glwall_state *state, uint32_t owner);
+
 void cleanup_audio(struct glwall_state *state);
 
 void audio_fft_process(float complex *data, int n);
 
+bool audio_latency_ms(struct glwall_state *state, double *latency_ms);
+
 int audio_read_recent_samples(struct glwall_state *state, int16_t *out, size_t count);
 void audio_test_overwrite_ring(struct glwall_state *state, const int16_t *samples, size_t count);
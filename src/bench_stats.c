@@ -0,0 +1,69 @@
+#include "bench_stats.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool bench_series_init(struct glwall_bench_series *series, size_t capacity) {
+    assert(series != NULL);
+
+    memset(series, 0, sizeof(*series));
+    if (capacity == 0)
+        return true;
+    series->samples = malloc(capacity * sizeof(*series->samples));
+    if (!series->samples)
+        return false;
+    series->capacity = capacity;
+    return true;
+}
+
+void bench_series_add(struct glwall_bench_series *series, double value) {
+    assert(series != NULL);
+
+    if (series->count < series->capacity)
+        series->samples[series->count++] = value;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, size_t count, double pct) {
+    size_t rank = (size_t)ceil(pct / 100.0 * (double)count);
+    if (rank < 1)
+        rank = 1;
+    return sorted[rank - 1];
+}
+
+void bench_series_summarize(struct glwall_bench_series *series,
+                            struct glwall_bench_summary *summary) {
+    assert(series != NULL);
+    assert(summary != NULL);
+
+    memset(summary, 0, sizeof(*summary));
+    summary->count = series->count;
+    if (series->count == 0)
+        return;
+
+    qsort(series->samples, series->count, sizeof(*series->samples), compare_double);
+    double sum = 0.0;
+    for (size_t i = 0; i < series->count; i++)
+        sum += series->samples[i];
+
+    summary->min = series->samples[0];
+    summary->max = series->samples[series->count - 1];
+    summary->p50 = percentile(series->samples, series->count, 50.0);
+    summary->p95 = percentile(series->samples, series->count, 95.0);
+    summary->p99 = percentile(series->samples, series->count, 99.0);
+    summary->mean = sum / (double)series->count;
+}
+
+void bench_series_free(struct glwall_bench_series *series) {
+    if (!series)
+        return;
+    free(series->samples);
+    memset(series, 0, sizeof(*series));
+}
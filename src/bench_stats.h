@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct glwall_bench_series {
+    double *samples;
+    size_t count;
+    size_t capacity;
+};
+
+struct glwall_bench_summary {
+    size_t count;
+    double min;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    double mean;
+};
+
+bool bench_series_init(struct glwall_bench_series *series, size_t capacity);
+
+void bench_series_add(struct glwall_bench_series *series, double value);
+
+void bench_series_summarize(struct glwall_bench_series *series,
+                            struct glwall_bench_summary *summary);
+
+void bench_series_free(struct glwall_bench_series *series);
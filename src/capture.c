@@ -0,0 +1,281 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "capture.h"
+#include "gl_alloc.h"
+#include "image.h"
+#include "render_thread.h"
+#include "scheduler.h"
+#include "utils.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CAPTURE_STATIC_WAIT_NS 1000000000ULL
+
+struct capture_job {
+    struct capture_job *next;
+    char path[PATH_MAX];
+    struct glwall_image image;
+};
+
+struct glwall_capture {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct capture_job *head;
+    struct capture_job *tail;
+    bool quit;
+    int seen_requests;
+    char dir[PATH_MAX];
+};
+
+static volatile sig_atomic_t capture_requests = 0;
+
+static void capture_signal_handler(int sig) {
+    (void)sig;
+    capture_requests++;
+}
+
+static void write_capture(struct capture_job *job) {
+    size_t pixels = (size_t)job->image.width_px * (size_t)job->image.height_px;
+    for (size_t i = 0; i < pixels; i++)
+        job->image.rgba[i * 4 + 3] = 255;
+
+    char tmp[PATH_MAX];
+    int n = snprintf(tmp, sizeof(tmp), "%s.tmp", job->path);
+    if (n < 0 || (size_t)n >= sizeof(tmp) || !save_png_rgba8(tmp, &job->image, true) ||
+        rename(tmp, job->path) != 0) {
+        remove(tmp);
+        LOG_WARN("File operation failed: unable to write capture '%s'", job->path);
+        return;
+    }
+    LOG_INFO("Frame capture written to %s (%d x %d)", job->path, job->image.width_px,
+             job->image.height_px);
+}
+
+static void *capture_worker_main(void *data) {
+    struct glwall_capture *capture = data;
+
+    pthread_mutex_lock(&capture->lock);
+    for (;;) {
+        while (!capture->head && !capture->quit)
+            pthread_cond_wait(&capture->cond, &capture->lock);
+        struct capture_job *job = capture->head;
+        if (!job)
+            break;
+        capture->head = job->next;
+        if (!capture->head)
+            capture->tail = NULL;
+        pthread_mutex_unlock(&capture->lock);
+
+        write_capture(job);
+        free_glwall_image(&job->image);
+        free(job);
+        pthread_mutex_lock(&capture->lock);
+    }
+    pthread_mutex_unlock(&capture->lock);
+    return NULL;
+}
+
+void capture_init(struct glwall_state *state) {
+    if (state->headless)
+        return;
+
+    struct glwall_capture *capture = calloc(1, sizeof(*capture));
+    if (!capture) {
+        LOG_WARN("%s", "Memory allocation failed: frame capture disabled");
+        return;
+    }
+    const char *xdg_runtime = getenv("XDG_RUNTIME_DIR");
+    snprintf(capture->dir, sizeof(capture->dir), "%s",
+             xdg_runtime && xdg_runtime[0] != '\0' ? xdg_runtime : "/tmp");
+
+    pthread_mutex_init(&capture->lock, NULL);
+    pthread_cond_init(&capture->cond, NULL);
+
+    sigset_t block, previous;
+    sigemptyset(&block);
+    sigaddset(&block, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &block, &previous);
+    int err = pthread_create(&capture->thread, NULL, capture_worker_main, capture);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        LOG_WARN("Frame capture: unable to start encoder thread (errno: %s); disabled",
+                 strerror(err));
+        pthread_cond_destroy(&capture->cond);
+        pthread_mutex_destroy(&capture->lock);
+        free(capture);
+        return;
+    }
+
+    capture->seen_requests = capture_requests;
+    state->capture = capture;
+    signal(SIGUSR2, capture_signal_handler);
+    LOG_DEBUG(state, "Frame capture: send SIGUSR2 to write PNGs to %s", capture->dir);
+}
+
+void capture_poll_request(struct glwall_state *state) {
+    struct glwall_capture *capture = state->capture;
+    int requests = capture_requests;
+    if (!capture || capture->seen_requests == requests)
+        return;
+    capture->seen_requests = requests;
+    LOG_DEBUG(state, "%s", "Frame capture requested");
+    bool deep_pause = state->power_mode == GLWALL_POWER_MODE_DEEP_PAUSED;
+    if (!state->render_once && !deep_pause)
+        return;
+
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        if (!output->configured)
+            continue;
+        if (output->render_thread)
+            render_thread_request_redraw(output);
+        else if (!output->frame_scheduled)
+            scheduler_request_frame(output);
+    }
+}
+
+static void enqueue_job(struct glwall_capture *capture, struct capture_job *job) {
+    pthread_mutex_lock(&capture->lock);
+    if (capture->tail)
+        capture->tail->next = job;
+    else
+        capture->head = job;
+    capture->tail = job;
+    pthread_cond_signal(&capture->cond);
+    pthread_mutex_unlock(&capture->lock);
+}
+
+static void start_readback(struct glwall_output *output) {
+    int32_t width = output->width_px;
+    int32_t height = output->height_px;
+    if (width <= 0 || height <= 0)
+        return;
+
+    if (!output->capture_pbo)
+        glGenBuffers(1, &output->capture_pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, output->capture_pbo);
+    if (output->capture_width_px != width || output->capture_height_px != height) {
+        gl_alloc_buffer_data(&output->state->gpu_mem, GLWALL_GPU_MEM_CAPTURE, output->output_name,
+                             GL_PIXEL_PACK_BUFFER, output->capture_pbo,
+                             (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+        output->capture_width_px = width;
+        output->capture_height_px = height;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    output->capture_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static struct capture_job *create_job(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    struct capture_job *job = calloc(1, sizeof(*job));
+    if (!job)
+        return NULL;
+
+    int n;
+    if (output->connector) {
+        n = snprintf(job->path, sizeof(job->path), "%s/glwall-capture-%s.png",
+                     state->capture->dir, output->connector);
+    } else {
+        n = snprintf(job->path, sizeof(job->path), "%s/glwall-capture-%u.png",
+                     state->capture->dir, output->output_name);
+    }
+    size_t size = (size_t)output->capture_width_px * (size_t)output->capture_height_px * 4;
+    job->image.rgba = n > 0 && (size_t)n < sizeof(job->path) ? malloc(size) : NULL;
+    if (!job->image.rgba) {
+        free(job);
+        return NULL;
+    }
+    job->image.width_px = output->capture_width_px;
+    job->image.height_px = output->capture_height_px;
+    return job;
+}
+
+static void finish_readback(struct glwall_output *output, GLuint64 timeout_ns) {
+    GLenum status =
+        glClientWaitSync(output->capture_fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return;
+    glDeleteSync(output->capture_fence);
+    output->capture_fence = NULL;
+    if (status == GL_WAIT_FAILED) {
+        LOG_WARN("Frame capture: readback of output %u failed", output->output_name);
+        return;
+    }
+
+    struct capture_job *job = create_job(output);
+    if (!job) {
+        LOG_WARN("%s", "Memory allocation failed: frame capture dropped");
+        return;
+    }
+    size_t size = (size_t)job->image.width_px * (size_t)job->image.height_px * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, output->capture_pbo);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size,
+                                          GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(job->image.rgba, mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        LOG_WARN("Frame capture: unable to map readback buffer of output %u",
+                 output->output_name);
+        free_glwall_image(&job->image);
+        free(job);
+        return;
+    }
+    enqueue_job(output->state->capture, job);
+}
+
+void capture_frame(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!state->capture)
+        return;
+
+    if (output->capture_fence)
+        finish_readback(output, 0);
+    int requests = capture_requests;
+    if (output->capture_fence || output->capture_seen == requests)
+        return;
+    output->capture_seen = requests;
+    start_readback(output);
+    bool deep_pause = state->power_mode == GLWALL_POWER_MODE_DEEP_PAUSED;
+    if ((state->render_once || deep_pause) && output->capture_fence)
+        finish_readback(output, CAPTURE_STATIC_WAIT_NS);
+}
+
+void capture_cleanup_output(struct glwall_output *output) {
+    if (output->capture_fence) {
+        glDeleteSync(output->capture_fence);
+        output->capture_fence = NULL;
+    }
+    if (output->capture_pbo) {
+        gl_alloc_delete_buffers(&output->state->gpu_mem, 1, &output->capture_pbo);
+        output->capture_pbo = 0;
+    }
+    output->capture_width_px = 0;
+    output->capture_height_px = 0;
+}
+
+void capture_cleanup(struct glwall_state *state) {
+    struct glwall_capture *capture = state->capture;
+    if (!capture)
+        return;
+
+    pthread_mutex_lock(&capture->lock);
+    capture->quit = true;
+    pthread_cond_signal(&capture->cond);
+    pthread_mutex_unlock(&capture->lock);
+    pthread_join(capture->thread, NULL);
+    pthread_cond_destroy(&capture->cond);
+    pthread_mutex_destroy(&capture->lock);
+    free(capture);
+    state->capture = NULL;
+}
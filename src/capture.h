@@ -0,0 +1,13 @@
+#pragma once
+
+#include "state.h"
+
+void capture_init(struct glwall_state *state);
+
+void capture_poll_request(struct glwall_state *state);
+
+void capture_frame(struct glwall_output *output);
+
+void capture_cleanup_output(struct glwall_output *output);
+
+void capture_cleanup(struct glwall_state *state);
@@ -0,0 +1,75 @@
+#include "contention.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define CONTENTION_RECENT_ALPHA 0.25
+#define CONTENTION_BASELINE_DRIFT 0.002
+#define CONTENTION_OVER_RATIO 1.5
+#define CONTENTION_UNDER_RATIO 1.2
+#define CONTENTION_MIN_EXCESS_MS 0.5
+#define CONTENTION_OVER_FRAMES 10
+#define CONTENTION_UNDER_FRAMES 120
+#define CONTENTION_COOLDOWN_FRAMES 30
+#define CONTENTION_RECALIBRATE_FRAMES 900
+
+void contention_reset(struct glwall_contention *contention) {
+    assert(contention != NULL);
+    memset(contention, 0, sizeof(*contention));
+}
+
+bool contention_update(struct glwall_contention *contention, double gpu_ms) {
+    assert(contention != NULL);
+
+    struct glwall_contention *c = contention;
+    if (!c->has_baseline) {
+        c->baseline_ms = gpu_ms;
+        c->recent_ms = gpu_ms;
+        c->has_baseline = true;
+        return false;
+    }
+
+    c->recent_ms += CONTENTION_RECENT_ALPHA * (gpu_ms - c->recent_ms);
+    bool over = c->recent_ms > c->baseline_ms * CONTENTION_OVER_RATIO &&
+                c->recent_ms - c->baseline_ms > CONTENTION_MIN_EXCESS_MS;
+    if (gpu_ms < c->baseline_ms)
+        c->baseline_ms = gpu_ms;
+    else if (!over)
+        c->baseline_ms += CONTENTION_BASELINE_DRIFT * (gpu_ms - c->baseline_ms);
+
+    if (over && c->level == GLWALL_CONTENTION_MAX_LEVEL) {
+        if (++c->stuck_count >= CONTENTION_RECALIBRATE_FRAMES) {
+            c->baseline_ms = c->recent_ms;
+            c->stuck_count = 0;
+        }
+    } else {
+        c->stuck_count = 0;
+    }
+
+    if (c->cooldown > 0) {
+        c->cooldown--;
+        return false;
+    }
+
+    if (over) {
+        c->under_count = 0;
+        if (++c->over_count >= CONTENTION_OVER_FRAMES && c->level < GLWALL_CONTENTION_MAX_LEVEL) {
+            c->level++;
+            c->over_count = 0;
+            c->cooldown = CONTENTION_COOLDOWN_FRAMES;
+            return true;
+        }
+    } else if (c->recent_ms < c->baseline_ms * CONTENTION_UNDER_RATIO) {
+        c->over_count = 0;
+        if (++c->under_count >= CONTENTION_UNDER_FRAMES && c->level > 0) {
+            c->level--;
+            c->under_count = 0;
+            c->cooldown = CONTENTION_COOLDOWN_FRAMES;
+            return true;
+        }
+    } else {
+        c->over_count = 0;
+        c->under_count = 0;
+    }
+    return false;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdbool.h>
+
+#define GLWALL_CONTENTION_MAX_LEVEL 3
+
+struct glwall_contention {
+    double baseline_ms;
+    double recent_ms;
+    bool has_baseline;
+    int over_count;
+    int under_count;
+    int stuck_count;
+    int cooldown;
+    int level;
+};
+
+void contention_reset(struct glwall_contention *contention);
+
+bool contention_update(struct glwall_contention *contention, double gpu_ms);
@@ -0,0 +1,143 @@
+#define _GNU_SOURCE
+
+#include "deep_pause.h"
+#include "pipeline.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static void pause_buffer_release(void *data, struct wl_buffer *buffer) {
+    struct glwall_output *output = data;
+    if (output->pause_buffer == buffer)
+        output->pause_buffer = NULL;
+    wl_buffer_destroy(buffer);
+}
+
+static const struct wl_buffer_listener pause_buffer_listener = {
+    .release = pause_buffer_release,
+};
+
+static void flip_rows(uint32_t *pixels, int32_t width, int32_t height) {
+    size_t stride = (size_t)width * 4;
+    uint32_t *row = malloc(stride);
+    if (!row)
+        return;
+    for (int32_t top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+        memcpy(row, pixels + (size_t)top * width, stride);
+        memcpy(pixels + (size_t)top * width, pixels + (size_t)bottom * width, stride);
+        memcpy(pixels + (size_t)bottom * width, row, stride);
+    }
+    free(row);
+}
+
+void deep_pause_capture(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (state->power_mode != GLWALL_POWER_MODE_DEEP_PAUSED || !state->shm)
+        return;
+
+    int32_t width = output->width_px;
+    int32_t height = output->height_px;
+    size_t size = (size_t)width * (size_t)height * 4;
+    if (width <= 0 || height <= 0 || size > INT32_MAX)
+        return;
+    int mem = memfd_create("glwall-pause", MFD_CLOEXEC);
+    if (mem < 0 || ftruncate(mem, (off_t)size) != 0) {
+        LOG_WARN("Deep pause: no shared memory for output %u; rendering continues",
+                 output->output_name);
+        if (mem >= 0)
+            close(mem);
+        return;
+    }
+    uint32_t *pixels = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem, 0);
+    if (pixels == MAP_FAILED) {
+        close(mem);
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, pixels);
+    flip_rows(pixels, width, height);
+    munmap(pixels, size);
+
+    struct wl_shm_pool *pool = wl_shm_create_pool(state->shm, mem, (int32_t)size);
+    struct wl_buffer *buffer = wl_shm_pool_create_buffer(pool, 0, width, height, width * 4,
+                                                         WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+    close(mem);
+    if (!buffer)
+        return;
+
+    wl_buffer_add_listener(buffer, &pause_buffer_listener, output);
+    output->pause_buffer = buffer;
+    output->pause_pending = true;
+}
+
+static bool all_outputs_paused(const struct glwall_state *state) {
+    for (const struct glwall_output *o = state->outputs; o; o = o->next) {
+        if (o->configured && !o->deep_paused)
+            return false;
+    }
+    return true;
+}
+
+bool deep_pause_enter_if_pending(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!output->pause_pending)
+        return false;
+    output->pause_pending = false;
+
+    wl_surface_attach(output->wl_surface, output->pause_buffer, 0, 0);
+    wl_surface_damage_buffer(output->wl_surface, 0, 0, output->width_px, output->height_px);
+    wl_surface_commit(output->wl_surface);
+    wl_display_flush(state->display);
+
+    struct glwall_gpu_mem *mem = &state->gpu_mem;
+    render_target_destroy(&output->dynres_target, mem);
+    render_target_destroy(&output->share_target, mem);
+    render_target_destroy(&output->checker_targets[0], mem);
+    render_target_destroy(&output->checker_targets[1], mem);
+    render_target_destroy(&output->keyframe_targets[0], mem);
+    render_target_destroy(&output->keyframe_targets[1], mem);
+    output->share_frame_valid = false;
+    output->checker_history_valid = false;
+    output->keyframe_count = 0;
+    output->deep_paused = true;
+    if (all_outputs_paused(state))
+        pipeline_release_targets(state);
+
+    if (!eglMakeCurrent(state->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, state->egl_context))
+        eglMakeCurrent(state->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(state->egl_display, output->egl_surface);
+    output->egl_surface = EGL_NO_SURFACE;
+    LOG_INFO("Deep pause: output %u shows a %d x %d wl_shm frame; GPU surfaces released",
+             output->output_name, output->width_px, output->height_px);
+    return true;
+}
+
+bool deep_pause_resume(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!output->deep_paused)
+        return true;
+
+    output->egl_surface = eglCreateWindowSurface(state->egl_display, state->egl_config,
+                                                 (EGLNativeWindowType)output->wl_egl_window, NULL);
+    if (output->egl_surface == EGL_NO_SURFACE) {
+        LOG_WARN("Deep pause: unable to recreate the surface of output %u (EGL error: 0x%x)",
+                 output->output_name, eglGetError());
+        return false;
+    }
+    output->deep_paused = false;
+    LOG_DEBUG(state, "Deep pause: output %u resumed rendering", output->output_name);
+    return true;
+}
+
+void deep_pause_cleanup_output(struct glwall_output *output) {
+    if (output->pause_buffer) {
+        wl_buffer_destroy(output->pause_buffer);
+        output->pause_buffer = NULL;
+    }
+}
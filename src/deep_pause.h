@@ -0,0 +1,11 @@
+#pragma once
+
+#include "state.h"
+
+void deep_pause_capture(struct glwall_output *output);
+
+bool deep_pause_enter_if_pending(struct glwall_output *output);
+
+bool deep_pause_resume(struct glwall_output *output);
+
+void deep_pause_cleanup_output(struct glwall_output *output);
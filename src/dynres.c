@@ -0,0 +1,92 @@
+#include "dynres.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+#define DYNRES_AVG_WEIGHT 0.2
+#define DYNRES_OVER_RATIO 1.10
+#define DYNRES_UNDER_RATIO 0.75
+#define DYNRES_OVER_FRAMES 3
+#define DYNRES_UNDER_FRAMES 30
+#define DYNRES_COOLDOWN_FRAMES 8
+#define DYNRES_STEP_UP 1.05f
+#define DYNRES_QUANTUM 64.0f
+
+static float clamp_scale(const struct glwall_dynres *dynres, float scale) {
+    if (scale < dynres->min_scale)
+        return dynres->min_scale;
+    if (scale > dynres->max_scale)
+        return dynres->max_scale;
+    return scale;
+}
+
+static bool apply_scale(struct glwall_dynres *dynres, float target) {
+    float steps = target * DYNRES_QUANTUM;
+    steps = target > dynres->scale ? ceilf(steps) : floorf(steps);
+    float scale = clamp_scale(dynres, steps / DYNRES_QUANTUM);
+    dynres->over_count = 0;
+    dynres->under_count = 0;
+    if (scale == dynres->scale)
+        return false;
+
+    double ratio = (double)scale / (double)dynres->scale;
+    dynres->avg_ms *= ratio * ratio;
+    dynres->scale = scale;
+    dynres->cooldown = DYNRES_COOLDOWN_FRAMES;
+    return true;
+}
+
+void dynres_init(struct glwall_dynres *dynres, float budget_ms, float min_scale, float max_scale) {
+    assert(dynres != NULL);
+    assert(min_scale > 0.0f && min_scale <= max_scale);
+
+    dynres->budget_ms = budget_ms;
+    dynres->min_scale = min_scale;
+    dynres->max_scale = max_scale;
+    dynres->scale = max_scale;
+    dynres->avg_ms = 0.0;
+    dynres->has_avg = false;
+    dynres->over_count = 0;
+    dynres->under_count = 0;
+    dynres->cooldown = 0;
+}
+
+bool dynres_update(struct glwall_dynres *dynres, double gpu_ms) {
+    assert(dynres != NULL);
+
+    if (dynres->budget_ms <= 0.0f || gpu_ms < 0.0)
+        return false;
+
+    if (dynres->has_avg) {
+        dynres->avg_ms += DYNRES_AVG_WEIGHT * (gpu_ms - dynres->avg_ms);
+    } else {
+        dynres->avg_ms = gpu_ms;
+        dynres->has_avg = true;
+    }
+
+    if (dynres->cooldown > 0) {
+        dynres->cooldown--;
+        return false;
+    }
+
+    double budget = (double)dynres->budget_ms;
+    if (dynres->avg_ms > budget * DYNRES_OVER_RATIO) {
+        dynres->over_count++;
+        dynres->under_count = 0;
+    } else if (dynres->avg_ms < budget * DYNRES_UNDER_RATIO) {
+        dynres->under_count++;
+        dynres->over_count = 0;
+    } else {
+        dynres->over_count = 0;
+        dynres->under_count = 0;
+    }
+
+    if (dynres->over_count >= DYNRES_OVER_FRAMES && dynres->scale > dynres->min_scale) {
+        return apply_scale(dynres, dynres->scale * (float)sqrt(budget / dynres->avg_ms));
+    }
+    if (dynres->under_count >= DYNRES_UNDER_FRAMES && dynres->scale < dynres->max_scale) {
+        return apply_scale(dynres, dynres->scale * DYNRES_STEP_UP);
+    }
+    return false;
+}
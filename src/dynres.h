@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+
+struct glwall_dynres {
+    float scale;
+    float min_scale;
+    float max_scale;
+    float budget_ms;
+    double avg_ms;
+    bool has_avg;
+    int over_count;
+    int under_count;
+    int cooldown;
+};
+
+void dynres_init(struct glwall_dynres *dynres, float budget_ms, float min_scale, float max_scale);
+
+bool dynres_update(struct glwall_dynres *dynres, double gpu_ms);
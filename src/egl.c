@@ -1,13 +1,71 @@
 #include "egl.h"
 #include "utils.h"
 
-bool init_egl(struct glwall_state *state) {
-    state->egl_display = eglGetDisplay(state->display);
-    if (state->egl_display == EGL_NO_DISPLAY) {
-        LOG_ERROR("%s", "EGL subsystem error: unable to obtain EGL display");
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_RENDER_DEVICES 16
+#define MAX_CONFIGS 64
+
+#define MAX_CONTEXT_ATTRIBS 9
+
+static bool has_extension(const char *extensions, const char *name) {
+    size_t len = strlen(name);
+    for (const char *p = extensions; p && (p = strstr(p, name)); p += len) {
+        if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+static void fill_context_attribs(EGLint attribs[MAX_CONTEXT_ATTRIBS], bool low_priority) {
+    int n = 0;
+    attribs[n++] = EGL_CONTEXT_MAJOR_VERSION;
+    attribs[n++] = 3;
+    attribs[n++] = EGL_CONTEXT_MINOR_VERSION;
+    attribs[n++] = 3;
+    attribs[n++] = EGL_CONTEXT_OPENGL_PROFILE_MASK;
+    attribs[n++] = EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT;
+    if (low_priority) {
+        attribs[n++] = EGL_CONTEXT_PRIORITY_LEVEL_IMG;
+        attribs[n++] = EGL_CONTEXT_PRIORITY_LOW_IMG;
+    }
+    attribs[n] = EGL_NONE;
+}
+
+static bool choose_config(struct glwall_state *state, const EGLint *attribs, bool opaque) {
+    EGLConfig configs[MAX_CONFIGS];
+    EGLint num_config;
+    if (!eglChooseConfig(state->egl_display, attribs, configs, MAX_CONFIGS, &num_config) ||
+        num_config < 1)
         return false;
+
+    EGLint chosen = 0, alpha_free = -1;
+    for (EGLint i = 0; opaque && i < num_config; i++) {
+        EGLint alpha = 0, depth = 0, stencil = 0;
+        eglGetConfigAttrib(state->egl_display, configs[i], EGL_ALPHA_SIZE, &alpha);
+        eglGetConfigAttrib(state->egl_display, configs[i], EGL_DEPTH_SIZE, &depth);
+        eglGetConfigAttrib(state->egl_display, configs[i], EGL_STENCIL_SIZE, &stencil);
+        if (alpha != 0)
+            continue;
+        if (depth == 0 && stencil == 0) {
+            alpha_free = i;
+            break;
+        }
+        if (alpha_free < 0)
+            alpha_free = i;
     }
+    if (alpha_free >= 0)
+        chosen = alpha_free;
+    else if (opaque)
+        LOG_DEBUG(state, "%s", "EGL subsystem: no alpha-free configuration; alpha is unused");
+    state->egl_config = configs[chosen];
+    LOG_DEBUG(state, "EGL subsystem: configuration selected (index: %d from %d candidates)",
+              (int)chosen, num_config);
+    return true;
+}
 
+static bool create_context(struct glwall_state *state, EGLint surface_type) {
     if (!eglInitialize(state->egl_display, NULL, NULL)) {
         LOG_ERROR("%s", "EGL subsystem error: initialization failed");
         return false;
@@ -18,8 +76,9 @@ bool init_egl(struct glwall_state *state) {
         return false;
     }
 
+    bool opaque = surface_type == EGL_WINDOW_BIT && state->opaque;
     EGLint const attribs[] = {EGL_SURFACE_TYPE,
-                              EGL_WINDOW_BIT,
+                              surface_type,
                               EGL_RENDERABLE_TYPE,
                               EGL_OPENGL_BIT,
                               EGL_RED_SIZE,
@@ -29,34 +88,141 @@ bool init_egl(struct glwall_state *state) {
                               EGL_BLUE_SIZE,
                               8,
                               EGL_ALPHA_SIZE,
-                              8,
+                              opaque ? 0 : 8,
                               EGL_NONE};
 
-    EGLint num_config;
-    if (!eglChooseConfig(state->egl_display, attribs, &state->egl_config, 1, &num_config) ||
-        num_config < 1) {
+    if (!choose_config(state, attribs, opaque)) {
         LOG_ERROR("%s", "EGL subsystem error: unable to select EGL configuration");
         return false;
     }
-    LOG_DEBUG(state, "EGL subsystem: configuration selected (index: 0 from %d candidates)",
-              num_config);
-
-    EGLint const context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
-                                      3,
-                                      EGL_CONTEXT_MINOR_VERSION,
-                                      3,
-                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
-                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
-                                      EGL_NONE};
 
+    const char *exts = eglQueryString(state->egl_display, EGL_EXTENSIONS);
+    bool low_priority = !state->headless && has_extension(exts, "EGL_IMG_context_priority");
+    EGLint context_attribs[MAX_CONTEXT_ATTRIBS];
+    fill_context_attribs(context_attribs, low_priority);
     state->egl_context =
         eglCreateContext(state->egl_display, state->egl_config, EGL_NO_CONTEXT, context_attribs);
+    if (state->egl_context == EGL_NO_CONTEXT && low_priority) {
+        LOG_WARN("%s", "EGL subsystem: low-priority context rejected; using default priority");
+        low_priority = false;
+        fill_context_attribs(context_attribs, false);
+        state->egl_context = eglCreateContext(state->egl_display, state->egl_config,
+                                              EGL_NO_CONTEXT, context_attribs);
+    }
     if (state->egl_context == EGL_NO_CONTEXT) {
         LOG_ERROR("%s", "Failed to create EGL context.");
         return false;
     }
+    state->egl_low_priority = low_priority;
     LOG_DEBUG(state, "%s", "EGL subsystem: context created with OpenGL 3.3 Core Profile");
 
+    if (low_priority) {
+        EGLint level = EGL_CONTEXT_PRIORITY_MEDIUM_IMG;
+        eglQueryContext(state->egl_display, state->egl_context, EGL_CONTEXT_PRIORITY_LEVEL_IMG,
+                        &level);
+        LOG_INFO("EGL subsystem: GPU context priority %s",
+                 level == EGL_CONTEXT_PRIORITY_LOW_IMG ? "low" : "unchanged (driver refused low)");
+    }
+    return true;
+}
+
+static const char *device_string(PFNEGLQUERYDEVICESTRINGEXTPROC query, EGLDeviceEXT device,
+                                 const char *extensions, const char *extension, EGLint name) {
+    return has_extension(extensions, extension) ? query(device, name) : NULL;
+}
+
+static EGLDeviceEXT find_render_device(struct glwall_state *state, const char *client_exts) {
+    PFNEGLQUERYDEVICESEXTPROC query_devices =
+        (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+    PFNEGLQUERYDEVICESTRINGEXTPROC query_string =
+        (PFNEGLQUERYDEVICESTRINGEXTPROC)eglGetProcAddress("eglQueryDeviceStringEXT");
+    if (!has_extension(client_exts, "EGL_EXT_device_enumeration") || !query_devices ||
+        !query_string) {
+        LOG_WARN("%s", "EGL subsystem: device enumeration is not supported");
+        return EGL_NO_DEVICE_EXT;
+    }
+
+    EGLDeviceEXT devices[MAX_RENDER_DEVICES];
+    EGLint count = 0;
+    if (!query_devices(MAX_RENDER_DEVICES, devices, &count))
+        count = 0;
+
+    char *endptr;
+    long index = strtol(state->render_device, &endptr, 10);
+    bool by_index = endptr != state->render_device && *endptr == '\0';
+    EGLDeviceEXT match = EGL_NO_DEVICE_EXT;
+    for (EGLint i = 0; i < count; i++) {
+        const char *exts = query_string(devices[i], EGL_EXTENSIONS);
+        const char *card = device_string(query_string, devices[i], exts, "EGL_EXT_device_drm",
+                                         EGL_DRM_DEVICE_FILE_EXT);
+        const char *node = device_string(query_string, devices[i], exts,
+                                         "EGL_EXT_device_drm_render_node",
+                                         EGL_DRM_RENDER_NODE_FILE_EXT);
+        bool software = has_extension(exts, "EGL_MESA_device_software");
+        LOG_INFO("EGL subsystem: device %d: %s%s%s", (int)i,
+                 software ? "software" : (card ? card : "unknown"), node ? " " : "",
+                 node ? node : "");
+
+        bool named = (by_index && index == i) ||
+                     (software && strcmp(state->render_device, "software") == 0) ||
+                     (card && strcmp(state->render_device, card) == 0) ||
+                     (node && strcmp(state->render_device, node) == 0);
+        if (named && match == EGL_NO_DEVICE_EXT)
+            match = devices[i];
+    }
+    if (match == EGL_NO_DEVICE_EXT)
+        LOG_WARN("EGL subsystem: no EGL device matches '%s'", state->render_device);
+    return match;
+}
+
+static EGLDisplay get_device_display(struct glwall_state *state, bool wayland) {
+    const char *client_exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    EGLDeviceEXT device = find_render_device(state, client_exts);
+    if (device == EGL_NO_DEVICE_EXT)
+        return EGL_NO_DISPLAY;
+
+    if (!wayland) {
+        if (!has_extension(client_exts, "EGL_EXT_platform_device")) {
+            LOG_WARN("%s", "EGL subsystem: EGL_EXT_platform_device is not supported");
+            return EGL_NO_DISPLAY;
+        }
+        return eglGetPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, NULL);
+    }
+
+    if (!has_extension(client_exts, "EGL_EXT_explicit_device") ||
+        !(has_extension(client_exts, "EGL_EXT_platform_wayland") ||
+          has_extension(client_exts, "EGL_KHR_platform_wayland"))) {
+        LOG_WARN("%s", "EGL subsystem: EGL_EXT_explicit_device is not supported on Wayland");
+        return EGL_NO_DISPLAY;
+    }
+    const EGLAttrib attribs[] = {EGL_DEVICE_EXT, (EGLAttrib)device, EGL_NONE};
+    return eglGetPlatformDisplay(EGL_PLATFORM_WAYLAND_EXT, state->display, attribs);
+}
+
+static EGLDisplay get_render_device_display(struct glwall_state *state, bool wayland) {
+    if (!state->render_device)
+        return EGL_NO_DISPLAY;
+    EGLDisplay display = get_device_display(state, wayland);
+    if (display == EGL_NO_DISPLAY) {
+        LOG_WARN("EGL subsystem: render device '%s' unavailable; using the default device",
+                 state->render_device);
+    } else {
+        LOG_INFO("EGL subsystem: rendering on device '%s'", state->render_device);
+    }
+    return display;
+}
+
+bool init_egl(struct glwall_state *state) {
+    state->egl_display = get_render_device_display(state, true);
+    if (state->egl_display == EGL_NO_DISPLAY)
+        state->egl_display = eglGetDisplay(state->display);
+    if (state->egl_display == EGL_NO_DISPLAY) {
+        LOG_ERROR("%s", "EGL subsystem error: unable to obtain EGL display");
+        return false;
+    }
+    if (!create_context(state, EGL_WINDOW_BIT))
+        return false;
+
     for (struct glwall_output *output = state->outputs; output; output = output->next) {
 
         if (!output->wl_egl_window) {
@@ -79,6 +245,56 @@ bool init_egl(struct glwall_state *state) {
     return true;
 }
 
+bool init_egl_headless(struct glwall_state *state) {
+    const char *client_exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    state->egl_display = get_render_device_display(state, false);
+    if (state->egl_display == EGL_NO_DISPLAY && get_platform_display &&
+        has_extension(client_exts, "EGL_MESA_platform_surfaceless")) {
+        state->egl_display =
+            get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (state->egl_display == EGL_NO_DISPLAY) {
+        LOG_DEBUG(state, "%s", "EGL subsystem: surfaceless platform unavailable; using default");
+        state->egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (state->egl_display == EGL_NO_DISPLAY) {
+        LOG_ERROR("%s", "EGL subsystem error: unable to obtain headless EGL display");
+        return false;
+    }
+    if (!create_context(state, EGL_PBUFFER_BIT))
+        return false;
+
+    struct glwall_output *output = state->outputs;
+    const char *exts = eglQueryString(state->egl_display, EGL_EXTENSIONS);
+    if (!has_extension(exts, "EGL_KHR_surfaceless_context")) {
+        EGLint const pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        output->egl_surface =
+            eglCreatePbufferSurface(state->egl_display, state->egl_config, pbuffer_attribs);
+        if (output->egl_surface == EGL_NO_SURFACE) {
+            LOG_ERROR("EGL subsystem error: unable to create pbuffer (EGL error: 0x%x)",
+                      eglGetError());
+            return false;
+        }
+    }
+
+    LOG_INFO("EGL subsystem: headless context ready (%s)",
+             output->egl_surface == EGL_NO_SURFACE ? "surfaceless" : "pbuffer");
+    return true;
+}
+
+EGLContext egl_create_shared_context(struct glwall_state *state) {
+    EGLint context_attribs[MAX_CONTEXT_ATTRIBS];
+    fill_context_attribs(context_attribs, state->egl_low_priority);
+    EGLContext context = eglCreateContext(state->egl_display, state->egl_config,
+                                          state->egl_context, context_attribs);
+    if (context == EGL_NO_CONTEXT)
+        LOG_ERROR("EGL subsystem error: unable to create shared context (EGL error: 0x%x)",
+                  eglGetError());
+    return context;
+}
+
 void cleanup_egl(struct glwall_state *state) {
     if (state->egl_display == EGL_NO_DISPLAY)
         return;
@@ -4,4 +4,8 @@
 
 bool init_egl(struct glwall_state *state);
 
+bool init_egl_headless(struct glwall_state *state);
+
+EGLContext egl_create_shared_context(struct glwall_state *state);
+
 void cleanup_egl(struct glwall_state *state);
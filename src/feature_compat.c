@@ -0,0 +1,86 @@
+#include "feature_compat.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+struct compat_rule {
+    uint32_t feature;
+    uint32_t conflicts;
+    bool drops_feature;
+    const char *message;
+};
+
+static const struct compat_rule compat_rules[] = {
+    {GLWALL_FEATURE_HEADLESS,
+     GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_TILE | GLWALL_FEATURE_DYNRES |
+         GLWALL_FEATURE_RENDER_THREADS | GLWALL_FEATURE_HUD | GLWALL_FEATURE_COOPERATIVE,
+     false,
+     "--checkerboard, --tile-budget, --dynres-budget, --render-threads, --hud and --cooperative "
+     "are ignored with --headless"},
+    {GLWALL_FEATURE_DEEP_PAUSED,
+     GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_TILE | GLWALL_FEATURE_KEYFRAME |
+         GLWALL_FEATURE_RENDER_THREADS,
+     false,
+     "--checkerboard, --tile-budget, --keyframe-fps and --render-threads are ignored with "
+     "--power-mode deep-paused"},
+    {GLWALL_FEATURE_PARTICLE, GLWALL_FEATURE_FRAGMENT | GLWALL_FEATURE_PRESET, true,
+     "--particle-state applies to vertex shaders only; ignored"},
+    {GLWALL_FEATURE_PARTICLE, GLWALL_FEATURE_TILE | GLWALL_FEATURE_RENDER_THREADS, false,
+     "--tile-budget and --render-threads are ignored with --particle-state"},
+    {GLWALL_FEATURE_VERTEX_BUDGET,
+     GLWALL_FEATURE_FRAGMENT | GLWALL_FEATURE_PRESET | GLWALL_FEATURE_HEADLESS, true,
+     "--vertex-budget applies to vertex shaders outside --headless; ignored"},
+    {GLWALL_FEATURE_VERTEX_BUDGET,
+     GLWALL_FEATURE_DYNRES | GLWALL_FEATURE_TILE | GLWALL_FEATURE_COOPERATIVE, false,
+     "--dynres-budget, --tile-budget and --cooperative are ignored with --vertex-budget"},
+    {GLWALL_FEATURE_KEYFRAME,
+     GLWALL_FEATURE_HEADLESS | GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_TILE |
+         GLWALL_FEATURE_DYNRES | GLWALL_FEATURE_VERTEX_BUDGET,
+     true,
+     "--keyframe-fps is ignored with --headless, --checkerboard, --tile-budget, --dynres-budget "
+     "and --vertex-budget"},
+    {GLWALL_FEATURE_KEYFRAME, GLWALL_FEATURE_COOPERATIVE | GLWALL_FEATURE_RENDER_THREADS, false,
+     "--cooperative and --render-threads are ignored with --keyframe-fps"},
+    {GLWALL_FEATURE_RENDER_THREADS, GLWALL_FEATURE_HUD | GLWALL_FEATURE_COOPERATIVE, true,
+     "--render-threads is ignored with --hud and --cooperative"},
+    {GLWALL_FEATURE_COOPERATIVE, GLWALL_FEATURE_DYNRES | GLWALL_FEATURE_TILE, true,
+     "--cooperative is ignored with --dynres-budget and --tile-budget"},
+    {GLWALL_FEATURE_CHECKERBOARD,
+     GLWALL_FEATURE_VERTEX | GLWALL_FEATURE_PRESET | GLWALL_FEATURE_NO_SHADER, true,
+     "--checkerboard applies to single fragment shaders only; ignored"},
+    {GLWALL_FEATURE_TILE, GLWALL_FEATURE_PRESET | GLWALL_FEATURE_NO_SHADER, true,
+     "--tile-budget applies to single shaders only; ignored"},
+    {GLWALL_FEATURE_TILE, GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_DYNRES, false,
+     "--checkerboard and --dynres-budget are ignored with --tile-budget"},
+    {GLWALL_FEATURE_TILE, GLWALL_FEATURE_HUD, false, "--hud is ignored with --tile-budget"},
+    {GLWALL_FEATURE_CHECKERBOARD, GLWALL_FEATURE_DYNRES, false,
+     "--dynres-budget is ignored with --checkerboard"},
+    {GLWALL_FEATURE_RENDER_THREADS,
+     GLWALL_FEATURE_PRESET | GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_TILE |
+         GLWALL_FEATURE_DYNRES | GLWALL_FEATURE_VERTEX_BUDGET,
+     true, "--render-threads applies to plain single shaders only; ignored"},
+};
+
+#define COMPAT_RULE_COUNT ((int)(sizeof(compat_rules) / sizeof(compat_rules[0])))
+
+uint32_t feature_compat_resolve(uint32_t features, uint32_t *fired) {
+    uint32_t mask = 0;
+    for (int i = 0; i < COMPAT_RULE_COUNT; i++) {
+        const struct compat_rule *rule = &compat_rules[i];
+        if (!(features & rule->feature) || !(features & rule->conflicts))
+            continue;
+        features &= ~(rule->drops_feature ? rule->feature : rule->conflicts);
+        mask |= 1u << i;
+    }
+    if (fired)
+        *fired = mask;
+    return features;
+}
+
+int feature_compat_rule_count(void) { return COMPAT_RULE_COUNT; }
+
+const char *feature_compat_rule_message(int rule) {
+    assert(rule >= 0 && rule < COMPAT_RULE_COUNT);
+    return compat_rules[rule].message;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+enum glwall_feature {
+    GLWALL_FEATURE_HEADLESS = 1u << 0,
+    GLWALL_FEATURE_DEEP_PAUSED = 1u << 1,
+    GLWALL_FEATURE_PRESET = 1u << 2,
+    GLWALL_FEATURE_NO_SHADER = 1u << 3,
+    GLWALL_FEATURE_VERTEX = 1u << 4,
+    GLWALL_FEATURE_FRAGMENT = 1u << 5,
+    GLWALL_FEATURE_CHECKERBOARD = 1u << 6,
+    GLWALL_FEATURE_TILE = 1u << 7,
+    GLWALL_FEATURE_DYNRES = 1u << 8,
+    GLWALL_FEATURE_RENDER_THREADS = 1u << 9,
+    GLWALL_FEATURE_HUD = 1u << 10,
+    GLWALL_FEATURE_COOPERATIVE = 1u << 11,
+    GLWALL_FEATURE_KEYFRAME = 1u << 12,
+    GLWALL_FEATURE_PARTICLE = 1u << 13,
+    GLWALL_FEATURE_VERTEX_BUDGET = 1u << 14,
+};
+
+uint32_t feature_compat_resolve(uint32_t features, uint32_t *fired);
+
+int feature_compat_rule_count(void);
+
+const char *feature_compat_rule_message(int rule);
@@ -0,0 +1,65 @@
+#include "frame_stats.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define FRAME_STATS_AVG_WEIGHT 0.05
+
+static double blend(double avg, double sample) {
+    return avg + (sample - avg) * FRAME_STATS_AVG_WEIGHT;
+}
+
+void frame_stats_reset(struct glwall_frame_stats *stats) {
+    assert(stats != NULL);
+    memset(stats, 0, sizeof(*stats));
+}
+
+void frame_stats_presented(struct glwall_frame_stats *stats, uint64_t present_ns, uint64_t seq,
+                           bool seq_valid, uint32_t refresh_ns, uint64_t render_start_ns,
+                           int32_t vblanks) {
+    assert(stats != NULL);
+
+    stats->presented++;
+    double latency_ms =
+        present_ns > render_start_ns ? (double)(present_ns - render_start_ns) / 1e6 : 0.0;
+    if (latency_ms > stats->latency_max_ms)
+        stats->latency_max_ms = latency_ms;
+
+    double jitter_ms = 0.0;
+    if (vblanks > 0 && stats->has_last && present_ns > stats->last_present_ns) {
+        uint64_t interval_ns = present_ns - stats->last_present_ns;
+        uint64_t elapsed = 0;
+        if (seq_valid && seq > stats->last_seq) {
+            elapsed = seq - stats->last_seq;
+        } else if (refresh_ns > 0) {
+            elapsed = (uint64_t)llround((double)interval_ns / (double)refresh_ns);
+        }
+        uint64_t expected = (uint64_t)vblanks;
+        if (elapsed > expected)
+            stats->missed_vblanks += elapsed - expected;
+        if (refresh_ns > 0) {
+            double target_ns = (double)expected * (double)refresh_ns;
+            jitter_ms = fabs((double)interval_ns - target_ns) / 1e6;
+        }
+    }
+
+    if (stats->has_avg) {
+        stats->latency_avg_ms = blend(stats->latency_avg_ms, latency_ms);
+        stats->jitter_avg_ms = blend(stats->jitter_avg_ms, jitter_ms);
+    } else {
+        stats->latency_avg_ms = latency_ms;
+        stats->jitter_avg_ms = jitter_ms;
+        stats->has_avg = true;
+    }
+
+    stats->last_present_ns = present_ns;
+    stats->last_seq = seq;
+    stats->has_last = true;
+}
+
+void frame_stats_discarded(struct glwall_frame_stats *stats) {
+    assert(stats != NULL);
+    stats->discarded++;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct glwall_frame_stats {
+    uint64_t presented;
+    uint64_t discarded;
+    uint64_t missed_vblanks;
+    uint64_t last_seq;
+    uint64_t last_present_ns;
+    bool has_last;
+    double latency_avg_ms;
+    double latency_max_ms;
+    double jitter_avg_ms;
+    bool has_avg;
+};
+
+void frame_stats_reset(struct glwall_frame_stats *stats);
+
+void frame_stats_presented(struct glwall_frame_stats *stats, uint64_t present_ns, uint64_t seq,
+                           bool seq_valid, uint32_t refresh_ns, uint64_t render_start_ns,
+                           int32_t vblanks);
+
+void frame_stats_discarded(struct glwall_frame_stats *stats);
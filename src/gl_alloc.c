@@ -0,0 +1,104 @@
+#include "gl_alloc.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#define MIB (1024.0 * 1024.0)
+
+static uint64_t bytes_per_pixel(GLint internal_format) {
+    switch (internal_format) {
+    case GL_R8:
+        return 1;
+    case GL_RG8:
+        return 2;
+    case GL_RGB8:
+        return 3;
+    case GL_RGBA16F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    case GL_R32F:
+    case GL_RGBA8:
+    default:
+        return 4;
+    }
+}
+
+void gl_alloc_tex_image_2d(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_category category,
+                           uint32_t owner, GLuint texture, GLint internal_format, GLsizei width,
+                           GLsizei height, GLenum format, GLenum type, const void *pixels) {
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, pixels);
+    gpu_mem_record(mem, GLWALL_GPU_MEM_TEXTURE, texture, category, owner,
+                   (uint64_t)width * (uint64_t)height * bytes_per_pixel(internal_format));
+}
+
+void gl_alloc_buffer_data(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_category category,
+                          uint32_t owner, GLenum target, GLuint buffer, GLsizeiptr size,
+                          const void *data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+    gpu_mem_record(mem, GLWALL_GPU_MEM_BUFFER, buffer, category, owner, (uint64_t)size);
+}
+
+void gl_alloc_renderbuffer_storage(struct glwall_gpu_mem *mem,
+                                   enum glwall_gpu_mem_category category, uint32_t owner,
+                                   GLuint renderbuffer, GLenum internal_format, GLsizei width,
+                                   GLsizei height) {
+    glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+    gpu_mem_record(mem, GLWALL_GPU_MEM_RENDERBUFFER, renderbuffer, category, owner,
+                   (uint64_t)width * (uint64_t)height *
+                       bytes_per_pixel((GLint)internal_format));
+}
+
+void gl_alloc_delete_textures(struct glwall_gpu_mem *mem, GLsizei n, const GLuint *textures) {
+    for (GLsizei i = 0; i < n; i++)
+        gpu_mem_release(mem, GLWALL_GPU_MEM_TEXTURE, textures[i]);
+    glDeleteTextures(n, textures);
+}
+
+void gl_alloc_delete_buffers(struct glwall_gpu_mem *mem, GLsizei n, const GLuint *buffers) {
+    for (GLsizei i = 0; i < n; i++)
+        gpu_mem_release(mem, GLWALL_GPU_MEM_BUFFER, buffers[i]);
+    glDeleteBuffers(n, buffers);
+}
+
+void gl_alloc_delete_renderbuffers(struct glwall_gpu_mem *mem, GLsizei n,
+                                   const GLuint *renderbuffers) {
+    for (GLsizei i = 0; i < n; i++)
+        gpu_mem_release(mem, GLWALL_GPU_MEM_RENDERBUFFER, renderbuffers[i]);
+    glDeleteRenderbuffers(n, renderbuffers);
+}
+
+void gl_alloc_log_report(struct glwall_state *state) {
+    assert(state != NULL);
+
+    struct glwall_gpu_mem *mem = &state->gpu_mem;
+    if (!mem->ready)
+        return;
+
+    pthread_mutex_lock(&mem->lock);
+    uint64_t total = mem->total_bytes;
+    uint64_t peak = mem->peak_bytes;
+    pthread_mutex_unlock(&mem->lock);
+    LOG_INFO("GPU memory: %.2f MiB allocated (peak %.2f MiB)", total / MIB, peak / MIB);
+
+    for (int i = 0; i < GLWALL_GPU_MEM_CATEGORY_COUNT; i++) {
+        struct glwall_gpu_mem_usage usage = gpu_mem_category_usage(mem, i);
+        if (usage.objects == 0)
+            continue;
+        LOG_INFO("GPU memory:   %-16s %9.2f MiB in %u object(s)", gpu_mem_category_name(i),
+                 usage.bytes / MIB, usage.objects);
+    }
+
+    struct glwall_gpu_mem_usage shared = gpu_mem_owner_usage(mem, GLWALL_GPU_MEM_SHARED);
+    LOG_INFO("GPU memory:   %-16s %9.2f MiB", "shared", shared.bytes / MIB);
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        struct glwall_gpu_mem_usage usage = gpu_mem_owner_usage(mem, output->output_name);
+        char label[32];
+        if (output->connector)
+            snprintf(label, sizeof(label), "output %s", output->connector);
+        else
+            snprintf(label, sizeof(label), "output %u", output->output_name);
+        LOG_INFO("GPU memory:   %-16s %9.2f MiB", label, usage.bytes / MIB);
+    }
+}
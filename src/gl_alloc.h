@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gpu_mem.h"
+#include "state.h"
+
+void gl_alloc_tex_image_2d(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_category category,
+                           uint32_t owner, GLuint texture, GLint internal_format, GLsizei width,
+                           GLsizei height, GLenum format, GLenum type, const void *pixels);
+
+void gl_alloc_buffer_data(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_category category,
+                          uint32_t owner, GLenum target, GLuint buffer, GLsizeiptr size,
+                          const void *data, GLenum usage);
+
+void gl_alloc_renderbuffer_storage(struct glwall_gpu_mem *mem,
+                                   enum glwall_gpu_mem_category category, uint32_t owner,
+                                   GLuint renderbuffer, GLenum internal_format, GLsizei width,
+                                   GLsizei height);
+
+void gl_alloc_delete_textures(struct glwall_gpu_mem *mem, GLsizei n, const GLuint *textures);
+
+void gl_alloc_delete_buffers(struct glwall_gpu_mem *mem, GLsizei n, const GLuint *buffers);
+
+void gl_alloc_delete_renderbuffers(struct glwall_gpu_mem *mem, GLsizei n,
+                                   const GLuint *renderbuffers);
+
+void gl_alloc_log_report(struct glwall_state *state);
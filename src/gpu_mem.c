@@ -0,0 +1,147 @@
+#include "gpu_mem.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define GPU_MEM_INITIAL_CAPACITY 32
+
+static const char *category_names[GLWALL_GPU_MEM_CATEGORY_COUNT] = {
+    [GLWALL_GPU_MEM_PASS_TARGET] = "pass targets",
+    [GLWALL_GPU_MEM_LUT] = "LUTs",
+    [GLWALL_GPU_MEM_SOURCE_IMAGE] = "source image",
+    [GLWALL_GPU_MEM_AUDIO] = "audio",
+    [GLWALL_GPU_MEM_UBO] = "uniform buffers",
+    [GLWALL_GPU_MEM_RENDER_TARGET] = "render targets",
+    [GLWALL_GPU_MEM_PARTICLES] = "particle state",
+    [GLWALL_GPU_MEM_CAPTURE] = "capture",
+    [GLWALL_GPU_MEM_SNAPSHOT] = "snapshot",
+    [GLWALL_GPU_MEM_HUD] = "HUD",
+};
+
+bool gpu_mem_init(struct glwall_gpu_mem *mem) {
+    assert(mem != NULL);
+
+    mem->entries = malloc(GPU_MEM_INITIAL_CAPACITY * sizeof(*mem->entries));
+    if (!mem->entries)
+        return false;
+    mem->capacity = GPU_MEM_INITIAL_CAPACITY;
+    mem->count = 0;
+    mem->total_bytes = 0;
+    mem->peak_bytes = 0;
+    pthread_mutex_init(&mem->lock, NULL);
+    mem->ready = true;
+    return true;
+}
+
+static struct glwall_gpu_mem_entry *find_entry(struct glwall_gpu_mem *mem,
+                                               enum glwall_gpu_mem_kind kind, uint32_t name) {
+    for (size_t i = 0; i < mem->count; i++) {
+        if (mem->entries[i].kind == kind && mem->entries[i].name == name)
+            return &mem->entries[i];
+    }
+    return NULL;
+}
+
+void gpu_mem_record(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_kind kind, uint32_t name,
+                    enum glwall_gpu_mem_category category, uint32_t owner, uint64_t bytes) {
+    assert(mem != NULL);
+    assert(category < GLWALL_GPU_MEM_CATEGORY_COUNT);
+
+    if (!mem->ready || name == 0)
+        return;
+
+    pthread_mutex_lock(&mem->lock);
+    struct glwall_gpu_mem_entry *entry = find_entry(mem, kind, name);
+    if (!entry && mem->count == mem->capacity) {
+        size_t capacity = mem->capacity * 2;
+        struct glwall_gpu_mem_entry *entries =
+            realloc(mem->entries, capacity * sizeof(*mem->entries));
+        if (!entries) {
+            pthread_mutex_unlock(&mem->lock);
+            return;
+        }
+        mem->entries = entries;
+        mem->capacity = capacity;
+    }
+    if (!entry) {
+        entry = &mem->entries[mem->count++];
+        entry->kind = kind;
+        entry->name = name;
+        entry->bytes = 0;
+    }
+    mem->total_bytes = mem->total_bytes - entry->bytes + bytes;
+    if (mem->total_bytes > mem->peak_bytes)
+        mem->peak_bytes = mem->total_bytes;
+    entry->category = category;
+    entry->owner = owner;
+    entry->bytes = bytes;
+    pthread_mutex_unlock(&mem->lock);
+}
+
+void gpu_mem_release(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_kind kind, uint32_t name) {
+    assert(mem != NULL);
+
+    if (!mem->ready || name == 0)
+        return;
+
+    pthread_mutex_lock(&mem->lock);
+    struct glwall_gpu_mem_entry *entry = find_entry(mem, kind, name);
+    if (entry) {
+        mem->total_bytes -= entry->bytes;
+        *entry = mem->entries[--mem->count];
+    }
+    pthread_mutex_unlock(&mem->lock);
+}
+
+struct glwall_gpu_mem_usage gpu_mem_category_usage(struct glwall_gpu_mem *mem,
+                                                   enum glwall_gpu_mem_category category) {
+    assert(mem != NULL);
+
+    struct glwall_gpu_mem_usage usage = {0, 0};
+    if (!mem->ready)
+        return usage;
+    pthread_mutex_lock(&mem->lock);
+    for (size_t i = 0; i < mem->count; i++) {
+        if (mem->entries[i].category == category) {
+            usage.bytes += mem->entries[i].bytes;
+            usage.objects++;
+        }
+    }
+    pthread_mutex_unlock(&mem->lock);
+    return usage;
+}
+
+struct glwall_gpu_mem_usage gpu_mem_owner_usage(struct glwall_gpu_mem *mem, uint32_t owner) {
+    assert(mem != NULL);
+
+    struct glwall_gpu_mem_usage usage = {0, 0};
+    if (!mem->ready)
+        return usage;
+    pthread_mutex_lock(&mem->lock);
+    for (size_t i = 0; i < mem->count; i++) {
+        if (mem->entries[i].owner == owner) {
+            usage.bytes += mem->entries[i].bytes;
+            usage.objects++;
+        }
+    }
+    pthread_mutex_unlock(&mem->lock);
+    return usage;
+}
+
+const char *gpu_mem_category_name(enum glwall_gpu_mem_category category) {
+    assert(category < GLWALL_GPU_MEM_CATEGORY_COUNT);
+    return category_names[category];
+}
+
+void gpu_mem_cleanup(struct glwall_gpu_mem *mem) {
+    assert(mem != NULL);
+
+    if (!mem->ready)
+        return;
+    pthread_mutex_destroy(&mem->lock);
+    free(mem->entries);
+    mem->entries = NULL;
+    mem->count = 0;
+    mem->capacity = 0;
+    mem->ready = false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GLWALL_GPU_MEM_SHARED 0
+
+enum glwall_gpu_mem_kind {
+    GLWALL_GPU_MEM_TEXTURE,
+    GLWALL_GPU_MEM_BUFFER,
+    GLWALL_GPU_MEM_RENDERBUFFER,
+};
+
+enum glwall_gpu_mem_category {
+    GLWALL_GPU_MEM_PASS_TARGET,
+    GLWALL_GPU_MEM_LUT,
+    GLWALL_GPU_MEM_SOURCE_IMAGE,
+    GLWALL_GPU_MEM_AUDIO,
+    GLWALL_GPU_MEM_UBO,
+    GLWALL_GPU_MEM_RENDER_TARGET,
+    GLWALL_GPU_MEM_PARTICLES,
+    GLWALL_GPU_MEM_CAPTURE,
+    GLWALL_GPU_MEM_SNAPSHOT,
+    GLWALL_GPU_MEM_HUD,
+    GLWALL_GPU_MEM_CATEGORY_COUNT,
+};
+
+struct glwall_gpu_mem_entry {
+    uint32_t name;
+    enum glwall_gpu_mem_kind kind;
+    enum glwall_gpu_mem_category category;
+    uint32_t owner;
+    uint64_t bytes;
+};
+
+struct glwall_gpu_mem {
+    pthread_mutex_t lock;
+    bool ready;
+    struct glwall_gpu_mem_entry *entries;
+    size_t count;
+    size_t capacity;
+    uint64_t total_bytes;
+    uint64_t peak_bytes;
+};
+
+bool gpu_mem_init(struct glwall_gpu_mem *mem);
+
+void gpu_mem_record(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_kind kind, uint32_t name,
+                    enum glwall_gpu_mem_category category, uint32_t owner, uint64_t bytes);
+
+void gpu_mem_release(struct glwall_gpu_mem *mem, enum glwall_gpu_mem_kind kind, uint32_t name);
+
+struct glwall_gpu_mem_usage {
+    uint64_t bytes;
+    uint32_t objects;
+};
+
+struct glwall_gpu_mem_usage gpu_mem_category_usage(struct glwall_gpu_mem *mem,
+                                                   enum glwall_gpu_mem_category category);
+struct glwall_gpu_mem_usage gpu_mem_owner_usage(struct glwall_gpu_mem *mem, uint32_t owner);
+
+const char *gpu_mem_category_name(enum glwall_gpu_mem_category category);
+
+void gpu_mem_cleanup(struct glwall_gpu_mem *mem);
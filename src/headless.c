@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "headless.h"
+#include "bench_stats.h"
+#include "image.h"
+#include "opengl.h"
+#include "pipeline.h"
+#include "presentation.h"
+#include "render_target.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#define GLWALL_HEADLESS_DEFAULT_FPS 60
+#define GLWALL_BENCHMARK_DEFAULT_FRAMES 300
+
+struct headless_bench {
+    struct glwall_gpu_timer timer;
+    bool gpu_timing;
+    struct glwall_bench_series cpu;
+    struct glwall_bench_series gpu;
+    struct glwall_bench_series *passes;
+    int pass_count;
+};
+
+bool init_headless(struct glwall_state *state) {
+    assert(state != NULL);
+
+    struct glwall_output *output = calloc(1, sizeof(*output));
+    if (!output) {
+        LOG_ERROR("%s", "Memory allocation failed: insufficient memory for headless output");
+        return false;
+    }
+    output->state = state;
+    output->timer_fd = -1;
+    output->scale = 1;
+    presentation_init_output(output);
+    output->logical_width = state->headless_width;
+    output->logical_height = state->headless_height;
+    output->width_px = state->headless_width;
+    output->height_px = state->headless_height;
+    output->configured = true;
+    state->outputs = output;
+    return true;
+}
+
+static void format_frame_path(const char *pattern, int frame, char *out, size_t out_size) {
+    const char *marker = strstr(pattern, "%d");
+    if (!marker) {
+        snprintf(out, out_size, "%s", pattern);
+        return;
+    }
+    snprintf(out, out_size, "%.*s%05d%s", (int)(marker - pattern), pattern, frame, marker + 2);
+}
+
+static bool has_suffix(const char *s, const char *suffix) {
+    size_t len = strlen(s), suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(s + len - suffix_len, suffix) == 0;
+}
+
+static bool write_frame(const char *path, const struct glwall_image *img) {
+    if (has_suffix(path, ".png"))
+        return save_png_rgba8(path, img, true);
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        LOG_ERROR("File operation failed: unable to open '%s' for writing", path);
+        return false;
+    }
+    size_t size = (size_t)img->width_px * (size_t)img->height_px * 4;
+    bool ok = fwrite(img->rgba, 1, size, fp) == size;
+    return fclose(fp) == 0 && ok;
+}
+
+static bool bench_init(struct glwall_state *state, struct headless_bench *bench, int frames) {
+    memset(bench, 0, sizeof(*bench));
+    bench->gpu_timing = gpu_timer_init(&bench->timer);
+    if (!bench->gpu_timing)
+        LOG_WARN("%s", "Benchmark: timer queries unavailable; GPU times not reported");
+    bench->pass_count = pipeline_pass_count(state);
+    if (bench->pass_count > 0) {
+        bench->passes = calloc((size_t)bench->pass_count, sizeof(*bench->passes));
+        if (!bench->passes)
+            return false;
+    }
+    if (!bench_series_init(&bench->cpu, (size_t)frames) ||
+        !bench_series_init(&bench->gpu, (size_t)frames))
+        return false;
+    for (int i = 0; i < bench->pass_count; i++) {
+        if (!bench_series_init(&bench->passes[i], (size_t)frames))
+            return false;
+    }
+    return true;
+}
+
+static void bench_cleanup(struct headless_bench *bench) {
+    if (bench->gpu_timing)
+        gpu_timer_destroy(&bench->timer);
+    bench_series_free(&bench->cpu);
+    bench_series_free(&bench->gpu);
+    for (int i = 0; i < bench->pass_count && bench->passes; i++)
+        bench_series_free(&bench->passes[i]);
+    free(bench->passes);
+}
+
+static void bench_collect(const struct glwall_state *state, struct headless_bench *bench,
+                          double cpu_ms) {
+    bench_series_add(&bench->cpu, cpu_ms);
+    double gpu_ms = 0.0;
+    if (bench->gpu_timing && gpu_timer_poll(&bench->timer, &gpu_ms))
+        bench_series_add(&bench->gpu, gpu_ms);
+    for (int i = 0; i < bench->pass_count; i++) {
+        if (pipeline_pass_gpu_ms(state, i, &gpu_ms))
+            bench_series_add(&bench->passes[i], gpu_ms);
+    }
+}
+
+static void write_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; s && *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void write_json_summary(FILE *f, struct glwall_bench_series *series) {
+    struct glwall_bench_summary s;
+    bench_series_summarize(series, &s);
+    if (s.count == 0) {
+        fputs("null", f);
+        return;
+    }
+    fprintf(f,
+            "{\"samples\": %zu, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, "
+            "\"max\": %.4f, \"mean\": %.4f}",
+            s.count, s.min, s.p50, s.p95, s.p99, s.max, s.mean);
+}
+
+static bool write_benchmark_report(const struct glwall_state *state, struct headless_bench *bench,
+                                   int frames, float dt) {
+    FILE *f = stdout;
+    if (state->benchmark_output) {
+        f = fopen(state->benchmark_output, "w");
+        if (!f) {
+            LOG_ERROR("File operation failed: unable to open '%s' for writing",
+                      state->benchmark_output);
+            return false;
+        }
+    }
+
+    struct rusage usage;
+    long peak_rss_kb = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    const struct glwall_output *output = state->outputs;
+
+    fputs("{\n  \"shader\": ", f);
+    write_json_string(f, state->shader_path);
+    fprintf(f, ",\n  \"width\": %d,\n  \"height\": %d,\n", output->width_px,
+            output->height_px);
+    fprintf(f, "  \"frames\": %d,\n  \"warmup\": %d,\n  \"time_step_ms\": %.4f,\n", frames,
+            state->benchmark_warmup, (double)dt * 1000.0);
+    fprintf(f, "  \"shader_build_ms\": %.3f,\n  \"peak_rss_kb\": %ld,\n",
+            state->shader_build_ms, peak_rss_kb);
+    fputs("  \"cpu_ms\": ", f);
+    write_json_summary(f, &bench->cpu);
+    fputs(",\n  \"gpu_ms\": ", f);
+    write_json_summary(f, &bench->gpu);
+    fputs(",\n  \"passes\": [", f);
+    for (int i = 0; i < bench->pass_count; i++) {
+        fprintf(f, "%s\n    {\"pass\": %d, \"gpu_ms\": ", i ? "," : "", i);
+        write_json_summary(f, &bench->passes[i]);
+        fputc('}', f);
+    }
+    fputs(bench->pass_count > 0 ? "\n  ]\n}\n" : "]\n}\n", f);
+
+    bool ok = !ferror(f);
+    if (f != stdout) {
+        ok = fclose(f) == 0 && ok;
+        if (ok)
+            LOG_INFO("Benchmark report written to %s", state->benchmark_output);
+    } else {
+        ok = fflush(f) == 0 && ok;
+    }
+    if (!ok)
+        LOG_ERROR("%s", "File operation failed: unable to write the benchmark report");
+    return ok;
+}
+
+bool run_headless(struct glwall_state *state) {
+    assert(state != NULL);
+
+    struct glwall_output *output = state->outputs;
+    struct glwall_render_target target = {0};
+    if (!render_target_ensure(&target, &state->gpu_mem, output->output_name, output->width_px,
+                              output->height_px)) {
+        LOG_ERROR("%s", "Headless rendering: unable to create offscreen target");
+        return false;
+    }
+
+    struct glwall_image frame_img = {0};
+    if (state->headless_output) {
+        frame_img.width_px = output->width_px;
+        frame_img.height_px = output->height_px;
+        frame_img.rgba = malloc((size_t)output->width_px * (size_t)output->height_px * 4);
+        if (!frame_img.rgba) {
+            LOG_ERROR("%s", "Memory allocation failed: insufficient memory for frame readback");
+            render_target_destroy(&target, &state->gpu_mem);
+            return false;
+        }
+    }
+
+    int frames = state->headless_frames;
+    if (frames <= 0)
+        frames = state->benchmark ? GLWALL_BENCHMARK_DEFAULT_FRAMES : 1;
+    int warmup = state->benchmark ? state->benchmark_warmup : 0;
+
+    struct headless_bench bench;
+    if (state->benchmark && !bench_init(state, &bench, frames)) {
+        LOG_ERROR("%s", "Memory allocation failed: insufficient memory for benchmark samples");
+        bench_cleanup(&bench);
+        free_glwall_image(&frame_img);
+        render_target_destroy(&target, &state->gpu_mem);
+        return false;
+    }
+
+    int32_t fps = state->fps_cap > 0 ? state->fps_cap : GLWALL_HEADLESS_DEFAULT_FPS;
+    float dt = 1.0f / (float)fps;
+    LOG_INFO("Headless rendering: %d frame(s) (+%d warmup) at %d x %d, %d fps time step", frames,
+             warmup, output->width_px, output->height_px, fps);
+
+    bool ok = true;
+    uint64_t start_ns = monotonic_time_ns();
+    int step = 0;
+    for (; step < warmup + frames && state->running && !quit_requested(); step++) {
+        bool measured = step >= warmup;
+        int frame = step - warmup;
+
+        if (state->benchmark && measured && bench.gpu_timing)
+            gpu_timer_begin(&bench.timer);
+        uint64_t cpu_start_ns = monotonic_time_ns();
+        render_offscreen(output, target.fbo, (float)step * dt, step == 0 ? 0.0f : dt, step + 1);
+        double cpu_ms = (double)(monotonic_time_ns() - cpu_start_ns) / 1e6;
+        if (state->benchmark && measured && bench.gpu_timing)
+            gpu_timer_end(&bench.timer);
+        glFinish();
+        if (state->benchmark && measured)
+            bench_collect(state, &bench, cpu_ms);
+
+        if (!state->headless_output || !measured)
+            continue;
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target.fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, output->width_px, output->height_px, GL_RGBA, GL_UNSIGNED_BYTE,
+                     frame_img.rgba);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+        char path[4096];
+        format_frame_path(state->headless_output, frame, path, sizeof(path));
+        if (!write_frame(path, &frame_img)) {
+            LOG_ERROR("Headless rendering: unable to write frame %d to '%s'", frame, path);
+            ok = false;
+            break;
+        }
+        LOG_DEBUG(state, "Headless rendering: frame %d written to %s", frame, path);
+    }
+    uint64_t elapsed_ns = monotonic_time_ns() - start_ns;
+
+    if (step > 0) {
+        LOG_INFO("Headless rendering: %d frame(s) in %.3f s (%.3f ms/frame)", step,
+                 (double)elapsed_ns / 1e9, (double)elapsed_ns / 1e6 / step);
+    }
+    if (state->benchmark) {
+        ok = write_benchmark_report(state, &bench, frames, dt) && ok;
+        bench_cleanup(&bench);
+    }
+    free_glwall_image(&frame_img);
+    render_target_destroy(&target, &state->gpu_mem);
+    return ok;
+}
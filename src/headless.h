@@ -0,0 +1,7 @@
+#pragma once
+
+#include "state.h"
+
+bool init_headless(struct glwall_state *state);
+
+bool run_headless(struct glwall_state *state);
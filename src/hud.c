@@ -0,0 +1,185 @@
+#include "hud.h"
+#include "audio.h"
+#include "gl_alloc.h"
+#include "opengl.h"
+#include "pipeline.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HUD_MAX_PASS_LINES 8
+#define HUD_FIXED_LINES 4
+#define HUD_MARGIN 2
+#define HUD_GRAPH_H 32
+#define HUD_WIDTH (GLWALL_HUD_HISTORY + 2 * HUD_MARGIN)
+#define HUD_OFFSET 4
+#define HUD_SCALE_ROWS 540
+
+static const char *hud_vertex_src =
+    "#version 330 core\n"
+    "const vec2 verts[4] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, "
+    "1.0));\n"
+    "out vec2 glwall_uv;\n"
+    "void main() {\n"
+    "    glwall_uv = vec2(verts[gl_VertexID].x, 1.0 - verts[gl_VertexID].y);\n"
+    "    gl_Position = vec4(verts[gl_VertexID] * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *hud_fragment_src =
+    "#version 330 core\n"
+    "in vec2 glwall_uv;\n"
+    "out vec4 glwall_color;\n"
+    "uniform sampler2D glwall_hud;\n"
+    "const vec4 palette[5] = vec4[](vec4(0.0, 0.0, 0.0, 0.6), vec4(1.0), vec4(0.3, 0.7, 1.0, "
+    "0.9), vec4(1.0, 0.6, 0.2, 0.9), vec4(1.0, 0.2, 0.2, 0.9));\n"
+    "void main() {\n"
+    "    int index = int(texture(glwall_hud, glwall_uv).r * 255.0 + 0.5);\n"
+    "    glwall_color = palette[min(index, 4)];\n"
+    "}\n";
+
+bool hud_init(struct glwall_state *state) {
+    if (!state->hud)
+        return true;
+
+    state->hud_program = create_shader_program(state, hud_vertex_src, hud_fragment_src);
+    if (!state->hud_program)
+        return false;
+    glUseProgram(state->hud_program);
+    glUniform1i(glGetUniformLocation(state->hud_program, "glwall_hud"), 0);
+    glUseProgram(0);
+    state->current_program = 0;
+
+    int passes = pipeline_pass_count(state);
+    int lines = HUD_FIXED_LINES + (passes < HUD_MAX_PASS_LINES ? passes : HUD_MAX_PASS_LINES);
+    struct glwall_hud_canvas *canvas = &state->hud_canvas;
+    canvas->width = HUD_WIDTH;
+    canvas->height = 3 * HUD_MARGIN + lines * GLWALL_HUD_LINE_H + HUD_GRAPH_H;
+    canvas->pixels = malloc((size_t)canvas->width * canvas->height);
+    if (!canvas->pixels) {
+        LOG_ERROR("%s", "Memory allocation failed: insufficient memory for HUD canvas");
+        return false;
+    }
+
+    GLint previous = 0;
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glGenTextures(1, &state->hud_texture);
+    glBindTexture(GL_TEXTURE_2D, state->hud_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl_alloc_tex_image_2d(&state->gpu_mem, GLWALL_GPU_MEM_HUD, GLWALL_GPU_MEM_SHARED,
+                          state->hud_texture, GL_R8, canvas->width, canvas->height, GL_RED,
+                          GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+    LOG_INFO("%s", "Frame timing HUD enabled");
+    return true;
+}
+
+static void draw_text_lines(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    struct glwall_hud_canvas *canvas = &state->hud_canvas;
+    const struct glwall_hud_history *history = &output->hud_history;
+    char line[32];
+    int32_t y = HUD_MARGIN;
+
+    snprintf(line, sizeof(line), "CPU %6.2f MS", history->cpu_ms.avg);
+    hud_canvas_text(canvas, HUD_MARGIN, y, line, GLWALL_HUD_CPU);
+    y += GLWALL_HUD_LINE_H;
+
+    if (history->gpu_ms.has_avg)
+        snprintf(line, sizeof(line), "GPU %6.2f MS", history->gpu_ms.avg);
+    else
+        snprintf(line, sizeof(line), "GPU     --");
+    hud_canvas_text(canvas, HUD_MARGIN, y, line, GLWALL_HUD_GPU);
+    y += GLWALL_HUD_LINE_H;
+
+    int passes = pipeline_pass_count(state);
+    for (int i = 0; i < passes && i < HUD_MAX_PASS_LINES; i++) {
+        double pass_ms;
+        if (pipeline_pass_last_gpu_ms(state, i, &pass_ms))
+            snprintf(line, sizeof(line), "P%-2d %6.2f MS", i, pass_ms);
+        else
+            snprintf(line, sizeof(line), "P%-2d     --", i);
+        hud_canvas_text(canvas, HUD_MARGIN, y, line, GLWALL_HUD_TEXT);
+        y += GLWALL_HUD_LINE_H;
+    }
+
+    double audio_ms;
+    if (audio_latency_ms(state, &audio_ms))
+        snprintf(line, sizeof(line), "AUD %6.1f MS", audio_ms);
+    else
+        snprintf(line, sizeof(line), "AUD     --");
+    hud_canvas_text(canvas, HUD_MARGIN, y, line, GLWALL_HUD_TEXT);
+    y += GLWALL_HUD_LINE_H;
+
+    snprintf(line, sizeof(line), "FPS %6.1f", history->fps);
+    hud_canvas_text(canvas, HUD_MARGIN, y, line, GLWALL_HUD_TEXT);
+}
+
+void hud_draw(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!state->hud_program)
+        return;
+
+    struct glwall_hud_history *history = &output->hud_history;
+    double cpu_ms = (double)(monotonic_time_ns() - output->frame_start_ns) / 1e6;
+    hud_history_frame(history, output->frame_start_ns, cpu_ms);
+
+    struct glwall_hud_canvas *canvas = &state->hud_canvas;
+    hud_canvas_clear(canvas);
+    draw_text_lines(output);
+
+    int32_t divisor = output->frame_divisor > 0 ? output->frame_divisor : 1;
+    double budget_ms = output->refresh_mhz > 0 ? 1e6 / output->refresh_mhz * divisor : 1000.0 / 60;
+    int32_t graph_y = canvas->height - HUD_MARGIN - HUD_GRAPH_H;
+    float graph_max = (float)(2.0 * budget_ms);
+    hud_canvas_graph(canvas, HUD_MARGIN, graph_y, GLWALL_HUD_HISTORY, HUD_GRAPH_H,
+                     &history->cpu_ms, graph_max, GLWALL_HUD_CPU);
+    hud_canvas_graph(canvas, HUD_MARGIN, graph_y, GLWALL_HUD_HISTORY, HUD_GRAPH_H,
+                     &history->gpu_ms, graph_max, GLWALL_HUD_GPU);
+    hud_canvas_hline(canvas, HUD_MARGIN, graph_y + HUD_GRAPH_H / 2, GLWALL_HUD_HISTORY,
+                     GLWALL_HUD_BUDGET);
+
+    GLint previous = 0;
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, state->hud_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, canvas->width, canvas->height, GL_RED,
+                    GL_UNSIGNED_BYTE, canvas->pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    int32_t scale = output->height_px / HUD_SCALE_ROWS;
+    scale = scale > 0 ? scale : 1;
+    int32_t hud_w = canvas->width * scale;
+    int32_t hud_h = canvas->height * scale;
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(HUD_OFFSET * scale, output->height_px - (HUD_OFFSET * scale) - hud_h, hud_w,
+               hud_h);
+    glUseProgram(state->hud_program);
+    state->current_program = state->hud_program;
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    if (depth_test)
+        glEnable(GL_DEPTH_TEST);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+}
+
+void hud_cleanup(struct glwall_state *state) {
+    if (state->hud_texture) {
+        gl_alloc_delete_textures(&state->gpu_mem, 1, &state->hud_texture);
+        state->hud_texture = 0;
+    }
+    if (state->hud_program) {
+        glDeleteProgram(state->hud_program);
+        state->hud_program = 0;
+    }
+    free(state->hud_canvas.pixels);
+    state->hud_canvas.pixels = NULL;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "state.h"
+
+bool hud_init(struct glwall_state *state);
+
+void hud_draw(struct glwall_output *output);
+
+void hud_cleanup(struct glwall_state *state);
@@ -0,0 +1,110 @@
+#include "hud_canvas.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define HUD_AVG_ALPHA 0.1
+
+static const char glyph_chars[] = " %-./0123456789:ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static const uint8_t glyphs[][GLWALL_HUD_GLYPH_H] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c},
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e},
+    {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e}, {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f},
+    {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e}, {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02},
+    {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e}, {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e},
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e},
+    {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c}, {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},
+    {0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11}, {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e}, {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f}, {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f}, {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}, {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11}, {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d}, {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e}, {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a}, {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},
+    {0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04}, {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},
+};
+
+_Static_assert(sizeof(glyphs) / sizeof(glyphs[0]) == sizeof(glyph_chars) - 1,
+               "one glyph per character");
+
+void hud_series_add(struct glwall_hud_series *series, float value) {
+    assert(series != NULL);
+
+    series->values[series->head] = value;
+    series->head = (series->head + 1) % GLWALL_HUD_HISTORY;
+    if (series->count < GLWALL_HUD_HISTORY)
+        series->count++;
+    if (series->has_avg) {
+        series->avg += HUD_AVG_ALPHA * (value - series->avg);
+    } else {
+        series->avg = value;
+        series->has_avg = true;
+    }
+}
+
+void hud_history_frame(struct glwall_hud_history *history, uint64_t frame_start_ns,
+                       double cpu_ms) {
+    assert(history != NULL);
+
+    if (history->last_frame_ns != 0 && frame_start_ns > history->last_frame_ns) {
+        double fps = 1e9 / (double)(frame_start_ns - history->last_frame_ns);
+        history->fps = history->fps > 0.0 ? history->fps + HUD_AVG_ALPHA * (fps - history->fps)
+                                           : fps;
+    }
+    history->last_frame_ns = frame_start_ns;
+    hud_series_add(&history->cpu_ms, (float)cpu_ms);
+}
+
+void hud_canvas_clear(struct glwall_hud_canvas *canvas) {
+    memset(canvas->pixels, GLWALL_HUD_BACKGROUND, (size_t)canvas->width * canvas->height);
+}
+
+static void put_pixel(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, uint8_t color) {
+    if (x >= 0 && y >= 0 && x < canvas->width && y < canvas->height)
+        canvas->pixels[(size_t)y * canvas->width + x] = color;
+}
+
+int32_t hud_canvas_text(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, const char *text,
+                        uint8_t color) {
+    for (const char *c = text; *c; c++, x += GLWALL_HUD_ADVANCE) {
+        char ch = *c >= 'a' && *c <= 'z' ? (char)(*c - 'a' + 'A') : *c;
+        const char *found = ch ? strchr(glyph_chars, ch) : NULL;
+        if (!found)
+            continue;
+        const uint8_t *glyph = glyphs[found - glyph_chars];
+        for (int row = 0; row < GLWALL_HUD_GLYPH_H; row++) {
+            for (int col = 0; col < GLWALL_HUD_GLYPH_W; col++) {
+                if (glyph[row] & (0x10 >> col))
+                    put_pixel(canvas, x + col, y + row, color);
+            }
+        }
+    }
+    return x;
+}
+
+void hud_canvas_graph(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, int32_t w, int32_t h,
+                      const struct glwall_hud_series *series, float max_value, uint8_t color) {
+    int32_t bars = series->count < w ? series->count : w;
+    for (int32_t i = 0; i < bars; i++) {
+        int index = (series->head - 1 - i + GLWALL_HUD_HISTORY) % GLWALL_HUD_HISTORY;
+        float v = series->values[index] / max_value;
+        int32_t bar_h = (int32_t)(v * (float)h + 0.5f);
+        bar_h = bar_h < 0 ? 0 : (bar_h > h ? h : bar_h);
+        int32_t column = x + w - 1 - i;
+        for (int32_t row = 0; row < bar_h; row++)
+            put_pixel(canvas, column, y + h - 1 - row, color);
+    }
+}
+
+void hud_canvas_hline(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, int32_t w,
+                      uint8_t color) {
+    for (int32_t i = 0; i < w; i++)
+        put_pixel(canvas, x + i, y, color);
+}
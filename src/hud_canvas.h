@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GLWALL_HUD_HISTORY 120
+#define GLWALL_HUD_GLYPH_W 5
+#define GLWALL_HUD_GLYPH_H 7
+#define GLWALL_HUD_ADVANCE 6
+#define GLWALL_HUD_LINE_H 9
+
+enum glwall_hud_color {
+    GLWALL_HUD_BACKGROUND,
+    GLWALL_HUD_TEXT,
+    GLWALL_HUD_CPU,
+    GLWALL_HUD_GPU,
+    GLWALL_HUD_BUDGET,
+};
+
+struct glwall_hud_series {
+    float values[GLWALL_HUD_HISTORY];
+    int head;
+    int count;
+    double avg;
+    bool has_avg;
+};
+
+struct glwall_hud_history {
+    struct glwall_hud_series cpu_ms;
+    struct glwall_hud_series gpu_ms;
+    uint64_t last_frame_ns;
+    double fps;
+};
+
+struct glwall_hud_canvas {
+    uint8_t *pixels;
+    int32_t width;
+    int32_t height;
+};
+
+void hud_series_add(struct glwall_hud_series *series, float value);
+
+void hud_history_frame(struct glwall_hud_history *history, uint64_t frame_start_ns, double cpu_ms);
+
+void hud_canvas_clear(struct glwall_hud_canvas *canvas);
+
+int32_t hud_canvas_text(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, const char *text,
+                        uint8_t color);
+
+void hud_canvas_graph(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, int32_t w, int32_t h,
+                      const struct glwall_hud_series *series, float max_value, uint8_t color);
+
+void hud_canvas_hline(struct glwall_hud_canvas *canvas, int32_t x, int32_t y, int32_t w,
+                      uint8_t color);
@@ -131,6 +131,53 @@ bool load_png_rgba8(const char *path, struct glwall_image *out) {
     return true;
 }
 
+bool save_png_rgba8(const char *path, const struct glwall_image *img, bool bottom_up) {
+    if (!path || !img || !img->rgba || img->width_px <= 0 || img->height_px <= 0)
+        return false;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        LOG_ERROR("File operation failed: unable to open '%s' for writing", path);
+        return false;
+    }
+
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+    png_bytep *row_ptrs = malloc(sizeof(png_bytep) * (size_t)img->height_px);
+    if (!png_ptr || !info_ptr || !row_ptrs) {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        free(row_ptrs);
+        fclose(fp);
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        LOG_ERROR("PNG encode failed: libpng error '%s'", path);
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        free(row_ptrs);
+        fclose(fp);
+        return false;
+    }
+
+    size_t stride = (size_t)img->width_px * 4;
+    for (int32_t y = 0; y < img->height_px; y++) {
+        int32_t row = bottom_up ? img->height_px - 1 - y : y;
+        row_ptrs[y] = (png_bytep)(img->rgba + (size_t)row * stride);
+    }
+
+    png_init_io(png_ptr, fp);
+    png_set_IHDR(png_ptr, info_ptr, (png_uint_32)img->width_px, (png_uint_32)img->height_px, 8,
+                 PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+    png_write_image(png_ptr, row_ptrs);
+    png_write_end(png_ptr, NULL);
+
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    free(row_ptrs);
+    return fclose(fp) == 0;
+}
+
 void free_glwall_image(struct glwall_image *img) {
     if (!img)
         return;
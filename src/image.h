@@ -12,4 +12,6 @@ struct glwall_image {
 
 bool load_png_rgba8(const char *path, struct glwall_image *out);
 
+bool save_png_rgba8(const char *path, const struct glwall_image *img, bool bottom_up);
+
 void free_glwall_image(struct glwall_image *img);
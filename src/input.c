@@ -194,9 +194,9 @@ bool init_input(struct glwall_state *state) {
         return false;
     }
 
-    if (state->outputs) {
-        input->screen_width = state->outputs->width_px;
-        input->screen_height = state->outputs->height_px;
+    if (state->outputs && state->outputs->logical_width > 0) {
+        input->screen_width = state->outputs->logical_width;
+        input->screen_height = state->outputs->logical_height;
     } else {
         input->screen_width = GLWALL_DEFAULT_SCREEN_WIDTH;
         input->screen_height = GLWALL_DEFAULT_SCREEN_HEIGHT;
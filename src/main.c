@@ -1,11 +1,20 @@
 #define _POSIX_C_SOURCE 200809L
 
+#include <errno.h>
+#include <poll.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include "capture.h"
 #include "egl.h"
+#include "headless.h"
 #include "input.h"
 #include "opengl.h"
+#include "render_thread.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "snapshot.h"
 #include "state.h"
 #include "utils.h"
 #include "wayland.h"
@@ -15,25 +24,108 @@ static void run_main_loop(struct glwall_state *state);
 static void run_main_loop(struct glwall_state *state) {
     LOG_INFO("%s", "Render loop started");
 
-    while (state->running && wl_display_dispatch(state->display) != -1) {
+    size_t output_count = 0;
+    for (struct glwall_output *output = state->outputs; output; output = output->next)
+        output_count++;
+
+    struct pollfd *fds = calloc(output_count + 2, sizeof(*fds));
+    if (!fds) {
+        LOG_ERROR("%s", "Memory allocation failed: insufficient memory for event loop");
+        return;
+    }
+
+    while (state->running && !quit_requested()) {
+        capture_poll_request(state);
+        while (wl_display_prepare_read(state->display) != 0) {
+            if (wl_display_dispatch_pending(state->display) < 0)
+                goto done;
+        }
+        if (wl_display_flush(state->display) < 0 && errno != EAGAIN) {
+            wl_display_cancel_read(state->display);
+            break;
+        }
+
+        fds[0].fd = wl_display_get_fd(state->display);
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        size_t i = 1;
+        for (struct glwall_output *output = state->outputs; output; output = output->next, i++) {
+            fds[i].fd = output->timer_fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        fds[i].fd = state->render_threads ? render_threads_publish_fd(state) : -1;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+
+        if (poll(fds, output_count + 2, -1) < 0) {
+            wl_display_cancel_read(state->display);
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("Event loop error: poll failed (errno: %s)", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            if (wl_display_read_events(state->display) < 0)
+                break;
+        } else {
+            wl_display_cancel_read(state->display);
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP)) {
+            LOG_ERROR("%s", "Event loop error: Wayland connection lost");
+            break;
+        }
+        if (wl_display_dispatch_pending(state->display) < 0)
+            break;
+        if (fds[output_count + 1].revents & POLLIN) {
+            if (state->input_impl)
+                poll_input_events(state);
+            render_threads_publish(state);
+        }
+
+        i = 1;
+        for (struct glwall_output *output = state->outputs; output; output = output->next, i++) {
+            if (fds[i].revents & POLLIN)
+                scheduler_handle_timer(output);
+        }
     }
+
+done:
+    free(fds);
 }
 
 int main(int argc, char *argv[]) {
     struct glwall_state state = {0};
+    int status = EXIT_FAILURE;
     LOG_DEBUG(&state, "Application initialization started (argc: %d)", argc);
 
     state.running = true;
     state.power_mode = GLWALL_POWER_MODE_FULL;
+    state.fps_cap = 0;
+    state.render_scale = 1.0f;
+    state.dynres_budget_ms = 0.0f;
+    state.dynres_min_scale = 0.5f;
+    state.dynres_max_scale = 1.0f;
+    state.output_sharing = true;
+    state.snapshot = true;
+    state.headless_frames = 0;
+    state.benchmark_warmup = 30;
     state.mouse_overlay_mode = GLWALL_MOUSE_OVERLAY_NONE;
     state.mouse_overlay_edge_height_px = 32;
     state.audio_enabled = false;
     state.audio_source = GLWALL_AUDIO_SOURCE_PULSEAUDIO;
     state.audio_device_name = NULL;
+    state.render_device = NULL;
+    state.transparent = false;
     state.image_path = NULL;
     state.allow_vertex_shaders = false;
     state.vertex_shader_path = NULL;
     state.vertex_count = 262144;
+    state.vertex_min_count = 0;
+    state.vertex_budget_ms = 0.0f;
+    state.particle_state = false;
+    state.keyframe_fps = 0;
     state.vertex_draw_mode = GL_POINTS;
     state.kernel_input_enabled = false;
     state.input_impl = NULL;
@@ -42,35 +134,65 @@ int main(int argc, char *argv[]) {
 
     parse_options(argc, argv, &state);
     LOG_DEBUG(&state, "%s", "Configuration parsing completed");
-
-    if (!init_wayland(&state))
-        goto cleanup;
-    LOG_DEBUG(&state, "%s", "Wayland subsystem initialization succeeded");
-    create_layer_surfaces(&state);
-    LOG_DEBUG(&state, "%s", "Layer surfaces created");
-    if (!state.running)
+    install_quit_handlers();
+    block_quit_signals(true);
+    if (state.benchmark && !state.headless) {
+        LOG_INFO("%s", "Benchmark mode: rendering headless at 1920 x 1080");
+        state.headless = true;
+        state.headless_width = 1920;
+        state.headless_height = 1080;
+    }
+    if (!replay_init(&state))
         goto cleanup;
+    snapshot_init(&state);
+    capture_init(&state);
 
-    if (!init_egl(&state))
-        goto cleanup;
-    LOG_DEBUG(&state, "%s", "EGL subsystem initialization succeeded");
+    if (state.headless) {
+        if (!init_headless(&state) || !init_egl_headless(&state))
+            goto cleanup;
+        LOG_DEBUG(&state, "%s", "Headless EGL initialization succeeded");
+    } else {
+        if (!init_wayland(&state))
+            goto cleanup;
+        LOG_DEBUG(&state, "%s", "Wayland subsystem initialization succeeded");
+        create_layer_surfaces(&state);
+        LOG_DEBUG(&state, "%s", "Layer surfaces created");
+        if (!state.running)
+            goto cleanup;
+
+        if (!init_egl(&state))
+            goto cleanup;
+        LOG_DEBUG(&state, "%s", "EGL subsystem initialization succeeded");
+    }
+    uint64_t build_start_ns = monotonic_time_ns();
     if (!init_opengl(&state))
         goto cleanup;
+    state.shader_build_ms = (double)(monotonic_time_ns() - build_start_ns) / 1e6;
     LOG_DEBUG(&state, "%s", "OpenGL subsystem initialization succeeded");
 
-    if (state.kernel_input_enabled) {
-        init_input(&state);
-        LOG_DEBUG(&state, "%s", "Input subsystem initialization completed");
-    }
+    activate_needed_subsystems(&state);
 
     clock_gettime(CLOCK_MONOTONIC, &state.start_time);
     LOG_DEBUG(&state, "%s", "Frame timer initialized");
 
-    start_rendering(&state);
-    run_main_loop(&state);
+    block_quit_signals(false);
+    if (state.headless) {
+        if (run_headless(&state))
+            status = EXIT_SUCCESS;
+    } else {
+        start_rendering(&state);
+        run_main_loop(&state);
+        status = EXIT_SUCCESS;
+    }
+    if (quit_requested())
+        LOG_INFO("%s", "Termination signal received");
 
 cleanup:
     LOG_INFO("%s", "Application shutdown initiated");
+    render_threads_stop(&state);
+    replay_cleanup(&state);
+    snapshot_cleanup(&state);
+    capture_cleanup(&state);
     LOG_DEBUG(&state, "%s", "Cleanup sequence: terminating input subsystem");
     cleanup_input(&state);
     LOG_DEBUG(&state, "%s", "Cleanup sequence: terminating OpenGL subsystem");
@@ -80,5 +202,5 @@ cleanup:
     LOG_DEBUG(&state, "%s", "Cleanup sequence: terminating Wayland subsystem");
     cleanup_wayland(&state);
     LOG_DEBUG(&state, "%s", "Application shutdown completed");
-    return EXIT_SUCCESS;
+    return status;
 }
\ No newline at end of file
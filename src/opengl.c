@@ -3,11 +3,27 @@
 #include <time.h>
 
 #include "audio.h"
+#include "capture.h"
+#include "deep_pause.h"
+#include "dynres.h"
+#include "feature_compat.h"
+#include "gl_alloc.h"
+#include "hud.h"
 #include "image.h"
 #include "input.h"
 #include "opengl.h"
+#include "particles.h"
 #include "pipeline.h"
+#include "presentation.h"
+#include "reflect.h"
+#include "render_target.h"
+#include "render_thread.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "snapshot.h"
 #include "utils.h"
+#include "vertex_budget.h"
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,25 +46,92 @@ static const char *vertex_shader_src = "#version 330 core\n"
                                        "    gl_Position = vec4(verts[gl_VertexID], 0.0, 1.0);\n"
                                        "}\n";
 
-static const char *vertex_preamble = "#version 330 core\n"
-                                     "#define vertexId float(gl_VertexID)\n"
-                                     "uniform float vertexCount;\n"
-                                     "uniform sampler2D sound;\n"
-                                     "out vec4 v_color;\n";
-
-static const char *fragment_preamble = "#version 330 core\n"
-                                       "layout(std140, binding = 0) uniform glwall_state_block {\n"
-                                       "  vec4 iResolution;\n"
-                                       "  vec4 iTime_frame; /* x=iTime, y=iTimeDelta, z=iFrame */\n"
-                                       "  vec4 iMouse;\n"
-                                       "};\n"
-                                       "#define gl_FragColor fragColor\n"
-                                       "out vec4 fragColor;\n"
-                                       "in vec4 v_color;\n";
+#define VERTEX_PREAMBLE_SRC                                                                       \
+    "#version 330 core\n"                                                                          \
+    "#define vertexId float(gl_VertexID)\n"                                                        \
+    "uniform float vertexCount;\n"                                                                 \
+    "uniform sampler2D sound;\n"                                                                   \
+    "out vec4 v_color;\n"
+
+static const char *vertex_preamble = VERTEX_PREAMBLE_SRC;
+
+static const char *particle_vertex_preamble =
+    VERTEX_PREAMBLE_SRC "#define GLWALL_PARTICLE_STATE 1\n"
+                        "layout(location = 0) in vec4 " GLWALL_PARTICLE_STATE_IN ";\n"
+                        "out vec4 " GLWALL_PARTICLE_STATE_OUT ";\n";
+
+#define GLWALL_MAX_TILES 64
+
+#define FRAGMENT_PREAMBLE_SRC                                                                     \
+    "#version 330 core\n"                                                                          \
+    "layout(std140, binding = 0) uniform glwall_state_block {\n"                                   \
+    "  vec4 iResolution;\n"                                                                        \
+    "  vec4 iTime_frame; /* x=iTime, y=iTimeDelta, z=iFrame */\n"                                  \
+    "  vec4 iMouse;\n"                                                                             \
+    "};\n"                                                                                         \
+    "#define gl_FragColor fragColor\n"                                                             \
+    "out vec4 fragColor;\n"                                                                        \
+    "in vec4 v_color;\n"
+
+static const char *fragment_preamble = FRAGMENT_PREAMBLE_SRC;
+
+static const char *checkerboard_fragment_preamble =
+    FRAGMENT_PREAMBLE_SRC
+    "uniform int glwall_checker_parity;\n"
+    "vec4 glwall_frag_coord() {\n"
+    "    vec4 c = gl_FragCoord;\n"
+    "    int row = int(c.y);\n"
+    "    c.x = floor(c.x) * 2.0 + float((row + glwall_checker_parity) & 1) + 0.5;\n"
+    "    return c;\n"
+    "}\n"
+    "#define gl_FragCoord glwall_frag_coord()\n";
+
+static const char *checkerboard_resolve_src =
+    "#version 330 core\n"
+    "uniform sampler2D glwall_current;\n"
+    "uniform sampler2D glwall_previous;\n"
+    "uniform int glwall_parity;\n"
+    "uniform int glwall_history_valid;\n"
+    "out vec4 fragColor;\n"
+    "vec4 fetch_current(ivec2 p) {\n"
+    "    ivec2 size = textureSize(glwall_current, 0);\n"
+    "    return texelFetch(glwall_current, clamp(ivec2(p.x >> 1, p.y), ivec2(0), size - 1), 0);\n"
+    "}\n"
+    "void main() {\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    if (((p.x + p.y) & 1) == glwall_parity) {\n"
+    "        fragColor = fetch_current(p);\n"
+    "        return;\n"
+    "    }\n"
+    "    vec4 l = fetch_current(p + ivec2(-1, 0));\n"
+    "    vec4 r = fetch_current(p + ivec2(1, 0));\n"
+    "    vec4 d = fetch_current(p + ivec2(0, -1));\n"
+    "    vec4 u = fetch_current(p + ivec2(0, 1));\n"
+    "    vec4 spatial = 0.25 * (l + r + d + u);\n"
+    "    if (glwall_history_valid == 0) {\n"
+    "        fragColor = spatial;\n"
+    "        return;\n"
+    "    }\n"
+    "    vec4 prev = texelFetch(glwall_previous, ivec2(p.x >> 1, p.y), 0);\n"
+    "    vec4 lo = min(min(l, r), min(d, u)) - 0.05;\n"
+    "    vec4 hi = max(max(l, r), max(d, u)) + 0.05;\n"
+    "    bool moved = any(lessThan(prev, lo)) || any(greaterThan(prev, hi));\n"
+    "    fragColor = moved ? spatial : prev;\n"
+    "}\n";
+
+static const char *keyframe_blend_src =
+    "#version 330 core\n"
+    "uniform sampler2D glwall_newer;\n"
+    "uniform sampler2D glwall_older;\n"
+    "uniform float glwall_mix;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    fragColor = mix(texelFetch(glwall_older, p, 0), texelFetch(glwall_newer, p, 0), "
+    "glwall_mix);\n"
+    "}\n";
 
 static GLuint compile_shader(struct glwall_state *state, GLenum type, const char *source);
-static GLuint create_shader_program(struct glwall_state *state, const char *vert_src,
-                                    const char *frag_src);
 static char *concat_preamble(const char *preamble, const char *source);
 
 static bool is_preset_path(const char *path) {
@@ -165,8 +248,8 @@ static GLuint compile_shader(struct glwall_state *state, GLenum type, const char
     return shader;
 }
 
-static GLuint create_shader_program(struct glwall_state *state, const char *vert_src,
-                                    const char *frag_src) {
+static GLuint build_shader_program(struct glwall_state *state, const char *vert_src,
+                                   const char *frag_src, const char *feedback_varying) {
     LOG_DEBUG(state, "%s", "OpenGL subsystem: shader program creation initiated");
     GLuint vert = compile_shader(state, GL_VERTEX_SHADER, vert_src);
     GLuint frag = compile_shader(state, GL_FRAGMENT_SHADER, frag_src);
@@ -176,6 +259,8 @@ static GLuint create_shader_program(struct glwall_state *state, const char *vert
     GLuint program = glCreateProgram();
     glAttachShader(program, vert);
     glAttachShader(program, frag);
+    if (feedback_varying)
+        glTransformFeedbackVaryings(program, 1, &feedback_varying, GL_INTERLEAVED_ATTRIBS);
     glLinkProgram(program);
 
     glDeleteShader(vert);
@@ -197,6 +282,186 @@ static GLuint create_shader_program(struct glwall_state *state, const char *vert
     return program;
 }
 
+GLuint create_shader_program(struct glwall_state *state, const char *vert_src,
+                             const char *frag_src) {
+    return build_shader_program(state, vert_src, frag_src, NULL);
+}
+
+static void user_program_lookup(struct glwall_user_program *user) {
+    GLuint program = user->program;
+    user->loc_resolution = glGetUniformLocation(program, "iResolution");
+    user->loc_resolution_vec2 = glGetUniformLocation(program, "resolution");
+
+    user->loc_time = glGetUniformLocation(program, "iTime");
+    if (user->loc_time == -1)
+        user->loc_time = glGetUniformLocation(program, "time");
+
+    user->loc_time_delta = glGetUniformLocation(program, "iTimeDelta");
+    user->loc_frame = glGetUniformLocation(program, "iFrame");
+
+    user->loc_mouse = glGetUniformLocation(program, "iMouse");
+    user->loc_mouse_vec2 = glGetUniformLocation(program, "mouse");
+
+    user->loc_sound = glGetUniformLocation(program, "sound");
+    user->loc_sound_res = glGetUniformLocation(program, "soundRes");
+    user->loc_vertex_count = glGetUniformLocation(program, "vertexCount");
+    user->resolution_w = 0;
+    user->resolution_h = 0;
+}
+
+bool user_program_link_copy(struct glwall_state *state, struct glwall_user_program *copy) {
+    assert(state->user_frag_src != NULL);
+
+    const char *vs = state->user_vert_src ? state->user_vert_src : vertex_shader_src;
+    copy->program = build_shader_program(state, vs, state->user_frag_src, NULL);
+    if (!copy->program)
+        return false;
+    user_program_lookup(copy);
+
+    glUseProgram(copy->program);
+    if (copy->loc_sound != -1)
+        glUniform1i(copy->loc_sound, 0);
+    if (copy->loc_sound_res != -1)
+        glUniform2f(copy->loc_sound_res, (float)GLWALL_AUDIO_TEX_WIDTH,
+                    (float)GLWALL_AUDIO_TEX_HEIGHT);
+    glUseProgram(0);
+    return true;
+}
+
+void user_program_destroy(struct glwall_user_program *user) {
+    if (user->program) {
+        glDeleteProgram(user->program);
+        user->program = 0;
+    }
+}
+
+static void select_render_mode(struct glwall_state *state) {
+    state->render_once = !reflect_needs_animation(state->shader_needs) && !state->particle_state;
+    if (state->render_once) {
+        LOG_INFO("%s", "Shader is time-invariant; rendering once per configure");
+        state->checkerboard = false;
+        state->keyframe_fps = 0;
+    } else {
+        LOG_DEBUG(state, "Shader needs mask: 0x%x", state->shader_needs);
+    }
+
+    bool per_output = (state->shader_needs & GLWALL_NEED_MOUSE) || state->checkerboard ||
+                      state->tile_budget_ms > 0.0f || state->dynres_budget_ms > 0.0f ||
+                      state->vertex_budget_ms > 0.0f || state->particle_state ||
+                      state->keyframe_fps > 0 || state->render_threads;
+    state->output_sharing = state->output_sharing && !per_output;
+    LOG_DEBUG(state, "Output sharing: %s", state->output_sharing ? "enabled" : "disabled");
+}
+
+static bool init_checkerboard(struct glwall_state *state) {
+    state->checker_resolve_program =
+        create_shader_program(state, vertex_shader_src, checkerboard_resolve_src);
+    if (!state->checker_resolve_program)
+        return false;
+
+    GLuint program = state->checker_resolve_program;
+    state->loc_checker_resolve_parity = glGetUniformLocation(program, "glwall_parity");
+    state->loc_checker_history_valid = glGetUniformLocation(program, "glwall_history_valid");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "glwall_current"), 0);
+    glUniform1i(glGetUniformLocation(program, "glwall_previous"), 1);
+    glUseProgram(0);
+    state->current_program = 0;
+    LOG_INFO("%s", "Checkerboard rendering enabled");
+    return true;
+}
+
+static bool init_keyframes(struct glwall_state *state) {
+    state->keyframe_blend_program =
+        create_shader_program(state, vertex_shader_src, keyframe_blend_src);
+    if (!state->keyframe_blend_program)
+        return false;
+
+    GLuint program = state->keyframe_blend_program;
+    state->loc_keyframe_mix = glGetUniformLocation(program, "glwall_mix");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "glwall_newer"), 0);
+    glUniform1i(glGetUniformLocation(program, "glwall_older"), 1);
+    glUseProgram(0);
+    state->current_program = 0;
+    LOG_INFO("Keyframe interpolation enabled: shading at %d fps", state->keyframe_fps);
+    return true;
+}
+
+void activate_needed_subsystems(struct glwall_state *state) {
+    bool want_audio = state->audio_enabled && (state->shader_needs & GLWALL_NEED_AUDIO);
+    if (want_audio && !state->audio.impl) {
+        if (!init_audio(state)) {
+            LOG_WARN("%s", "Audio subsystem initialization failed, audio disabled");
+            state->audio_enabled = false;
+        }
+    } else if (!want_audio && state->audio.impl) {
+        cleanup_audio(state);
+    }
+    if (state->audio_enabled && !want_audio) {
+        LOG_INFO("%s", "Audio capture idle: shader does not sample 'sound'");
+    }
+
+    bool want_input = state->kernel_input_enabled && (state->shader_needs & GLWALL_NEED_MOUSE);
+    if (want_input && !state->input_impl) {
+        init_input(state);
+        LOG_DEBUG(state, "%s", "Input subsystem initialization completed");
+    } else if (!want_input && state->input_impl) {
+        cleanup_input(state);
+    }
+    if (state->kernel_input_enabled && !want_input) {
+        LOG_INFO("%s", "Kernel input idle: shader does not read the mouse");
+    }
+}
+
+static uint32_t feature_if(bool enabled, uint32_t feature) { return enabled ? feature : 0; }
+
+static void resolve_feature_conflicts(struct glwall_state *state, bool vertex_mode, bool preset) {
+    uint32_t features =
+        feature_if(state->headless, GLWALL_FEATURE_HEADLESS) |
+        feature_if(state->power_mode == GLWALL_POWER_MODE_DEEP_PAUSED,
+                   GLWALL_FEATURE_DEEP_PAUSED) |
+        feature_if(preset, GLWALL_FEATURE_PRESET) |
+        feature_if(!state->shader_path, GLWALL_FEATURE_NO_SHADER) |
+        feature_if(vertex_mode, GLWALL_FEATURE_VERTEX) |
+        feature_if(!vertex_mode, GLWALL_FEATURE_FRAGMENT) |
+        feature_if(state->checkerboard, GLWALL_FEATURE_CHECKERBOARD) |
+        feature_if(state->tile_budget_ms > 0.0f, GLWALL_FEATURE_TILE) |
+        feature_if(state->dynres_budget_ms > 0.0f, GLWALL_FEATURE_DYNRES) |
+        feature_if(state->render_threads, GLWALL_FEATURE_RENDER_THREADS) |
+        feature_if(state->hud, GLWALL_FEATURE_HUD) |
+        feature_if(state->cooperative, GLWALL_FEATURE_COOPERATIVE) |
+        feature_if(state->keyframe_fps > 0, GLWALL_FEATURE_KEYFRAME) |
+        feature_if(state->particle_state, GLWALL_FEATURE_PARTICLE) |
+        feature_if(state->vertex_budget_ms > 0.0f, GLWALL_FEATURE_VERTEX_BUDGET);
+
+    uint32_t fired;
+    features = feature_compat_resolve(features, &fired);
+    for (int i = 0; i < feature_compat_rule_count(); i++) {
+        if (fired & (1u << i))
+            LOG_WARN("%s", feature_compat_rule_message(i));
+    }
+
+    if (!(features & GLWALL_FEATURE_CHECKERBOARD))
+        state->checkerboard = false;
+    if (!(features & GLWALL_FEATURE_TILE))
+        state->tile_budget_ms = 0.0f;
+    if (!(features & GLWALL_FEATURE_DYNRES))
+        state->dynres_budget_ms = 0.0f;
+    if (!(features & GLWALL_FEATURE_RENDER_THREADS))
+        state->render_threads = false;
+    if (!(features & GLWALL_FEATURE_HUD))
+        state->hud = false;
+    if (!(features & GLWALL_FEATURE_COOPERATIVE))
+        state->cooperative = false;
+    if (!(features & GLWALL_FEATURE_KEYFRAME))
+        state->keyframe_fps = 0;
+    if (!(features & GLWALL_FEATURE_PARTICLE))
+        state->particle_state = false;
+    if (!(features & GLWALL_FEATURE_VERTEX_BUDGET))
+        state->vertex_budget_ms = 0.0f;
+}
+
 bool init_opengl(struct glwall_state *state) {
     assert(state != NULL);
     assert(state->outputs != NULL);
@@ -211,6 +476,8 @@ bool init_opengl(struct glwall_state *state) {
         LOG_ERROR("%s", "EGL subsystem error: unable to set current EGL context");
         return false;
     }
+    if (!gpu_mem_init(&state->gpu_mem))
+        LOG_WARN("%s", "GPU memory accounting unavailable");
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
         LOG_ERROR("%s", "OpenGL subsystem error: GLEW initialization failed");
@@ -222,24 +489,61 @@ bool init_opengl(struct glwall_state *state) {
     glGenVertexArrays(1, &state->vao);
     glBindVertexArray(state->vao);
 
+    bool vertex_mode = state->allow_vertex_shaders && state->vertex_shader_path;
+    bool preset = state->shader_path && is_preset_path(state->shader_path);
+    resolve_feature_conflicts(state, vertex_mode, preset);
+
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        if (state->dynres_budget_ms > 0.0f) {
+            dynres_init(&output->dynres, state->dynres_budget_ms, state->dynres_min_scale,
+                        state->dynres_max_scale);
+        }
+        if (state->vertex_budget_ms > 0.0f) {
+            vertex_budget_init(&output->vertex_budget, state->vertex_budget_ms,
+                               state->vertex_min_count, state->vertex_count);
+        }
+        if (state->dynres_budget_ms > 0.0f || state->tile_budget_ms > 0.0f ||
+            state->vertex_budget_ms > 0.0f) {
+            if (!gpu_timer_init(&output->gpu_timer)) {
+                LOG_WARN("OpenGL subsystem: timer queries unavailable for output %u",
+                         output->output_name);
+            }
+        }
+        if ((state->hud || state->cooperative) && !gpu_timer_init(&output->frame_timer)) {
+            LOG_WARN("OpenGL subsystem: frame timer queries unavailable for output %u",
+                     output->output_name);
+        }
+        contention_reset(&output->contention);
+        output->tile_count = 1;
+    }
+
     glEnable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
 
     state->ubo_state = 0;
     glGenBuffers(1, &state->ubo_state);
     glBindBuffer(GL_UNIFORM_BUFFER, state->ubo_state);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 12, NULL, GL_DYNAMIC_DRAW);
+    gl_alloc_buffer_data(&state->gpu_mem, GLWALL_GPU_MEM_UBO, GLWALL_GPU_MEM_SHARED,
+                         GL_UNIFORM_BUFFER, state->ubo_state, sizeof(float) * 12, NULL,
+                         GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, state->ubo_state);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
     state->pass_ubo = 0;
     glGenBuffers(1, &state->pass_ubo);
     glBindBuffer(GL_UNIFORM_BUFFER, state->pass_ubo);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 16, NULL, GL_DYNAMIC_DRAW);
+    gl_alloc_buffer_data(&state->gpu_mem, GLWALL_GPU_MEM_UBO, GLWALL_GPU_MEM_SHARED,
+                         GL_UNIFORM_BUFFER, state->pass_ubo, sizeof(float) * 16, NULL,
+                         GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_UNIFORM_BUFFER, 1, state->pass_ubo);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    if (state->shader_path && is_preset_path(state->shader_path)) {
+    if (state->keyframe_fps > 0 && !init_keyframes(state)) {
+        LOG_WARN("%s", "Keyframe blend shader failed to build; shading every frame");
+        state->keyframe_fps = 0;
+    }
+
+    if (preset) {
         if (state->allow_vertex_shaders || state->vertex_shader_path) {
             LOG_WARN("Vertex shader overrides are ignored for presets (%s)", state->shader_path);
         }
@@ -255,8 +559,10 @@ bool init_opengl(struct glwall_state *state) {
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
                 glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, img.width_px, img.height_px, 0, GL_RGBA,
-                             GL_UNSIGNED_BYTE, img.rgba);
+                gl_alloc_tex_image_2d(&state->gpu_mem, GLWALL_GPU_MEM_SOURCE_IMAGE,
+                                      GLWALL_GPU_MEM_SHARED, state->source_image_texture,
+                                      GL_RGBA8, img.width_px, img.height_px, GL_RGBA,
+                                      GL_UNSIGNED_BYTE, img.rgba);
                 glBindTexture(GL_TEXTURE_2D, 0);
                 state->source_image_width_px = img.width_px;
                 state->source_image_height_px = img.height_px;
@@ -272,11 +578,7 @@ bool init_opengl(struct glwall_state *state) {
             return false;
         }
 
-        if (!init_audio(state)) {
-            LOG_WARN("%s", "Audio subsystem initialization failed, audio disabled");
-            state->audio_enabled = false;
-        }
-
+        select_render_mode(state);
         LOG_DEBUG(state, "%s", "OpenGL subsystem initialization completed successfully (preset)");
         return true;
     }
@@ -292,7 +594,10 @@ bool init_opengl(struct glwall_state *state) {
         if (!stripped_frag_src)
             return false;
 
-        frag_src = concat_preamble(fragment_preamble, stripped_frag_src);
+        state->shader_needs |= reflect_source_needs(stripped_frag_src);
+        frag_src = concat_preamble(state->checkerboard ? checkerboard_fragment_preamble
+                                                       : fragment_preamble,
+                                   stripped_frag_src);
         free(stripped_frag_src);
     } else {
 
@@ -322,7 +627,10 @@ bool init_opengl(struct glwall_state *state) {
             return false;
         }
 
-        vert_src = concat_preamble(vertex_preamble, stripped_vert_src);
+        state->shader_needs |= reflect_source_needs(stripped_vert_src);
+        vert_src = concat_preamble(state->particle_state ? particle_vertex_preamble
+                                                         : vertex_preamble,
+                                   stripped_vert_src);
         free(stripped_vert_src);
         if (!vert_src) {
             free(frag_src);
@@ -331,36 +639,29 @@ bool init_opengl(struct glwall_state *state) {
     }
 
     const char *vs = vert_src ? vert_src : vertex_shader_src;
-    state->shader_program = create_shader_program(state, vs, frag_src);
-    free(frag_src);
-    if (vert_src)
+    state->user_program.program = build_shader_program(
+        state, vs, frag_src, state->particle_state ? GLWALL_PARTICLE_STATE_OUT : NULL);
+    if (state->render_threads && state->user_program.program) {
+        state->user_frag_src = frag_src;
+        state->user_vert_src = vert_src;
+    } else {
+        free(frag_src);
         free(vert_src);
+    }
 
-    if (!state->shader_program)
+    if (!state->user_program.program)
         return false;
 
     state->current_program = 0;
+    state->shader_needs |= reflect_program_needs(state->user_program.program);
 
-    state->loc_resolution = glGetUniformLocation(state->shader_program, "iResolution");
-    state->loc_resolution_vec2 = glGetUniformLocation(state->shader_program, "resolution");
-
-    state->loc_time = glGetUniformLocation(state->shader_program, "iTime");
-    if (state->loc_time == -1)
-        state->loc_time = glGetUniformLocation(state->shader_program, "time");
-
-    state->loc_time_delta = glGetUniformLocation(state->shader_program, "iTimeDelta");
-    state->loc_frame = glGetUniformLocation(state->shader_program, "iFrame");
-
-    state->loc_mouse = glGetUniformLocation(state->shader_program, "iMouse");
-    state->loc_mouse_vec2 = glGetUniformLocation(state->shader_program, "mouse");
-
-    state->loc_sound = glGetUniformLocation(state->shader_program, "sound");
-    state->loc_sound_res = glGetUniformLocation(state->shader_program, "soundRes");
-    state->loc_vertex_count = glGetUniformLocation(state->shader_program, "vertexCount");
+    user_program_lookup(&state->user_program);
+    state->loc_checker_parity =
+        glGetUniformLocation(state->user_program.program, "glwall_checker_parity");
 
-    if (!init_audio(state)) {
-        LOG_WARN("%s", "Audio subsystem initialization failed, audio disabled");
-        state->audio_enabled = false;
+    if (state->checkerboard && !init_checkerboard(state)) {
+        LOG_WARN("%s", "Checkerboard resolve shader failed to build; rendering at full rate");
+        state->checkerboard = false;
     }
 
     state->profiling_enabled = getenv("GLWALL_PROFILE") != NULL;
@@ -370,47 +671,599 @@ bool init_opengl(struct glwall_state *state) {
      * complex I/O inside an async signal handler. */
     signal(SIGUSR1, glwall_profile_signal_handler);
 
-    if (state->loc_sound != -1) {
-        if (state->current_program != state->shader_program) {
-            glUseProgram(state->shader_program);
-            state->current_program = state->shader_program;
+    if (state->user_program.loc_sound != -1) {
+        if (state->current_program != state->user_program.program) {
+            glUseProgram(state->user_program.program);
+            state->current_program = state->user_program.program;
         }
-        glUniform1i(state->loc_sound, 0);
+        glUniform1i(state->user_program.loc_sound, 0);
         glUseProgram(0);
         state->current_program = 0;
     }
 
+    if (!hud_init(state)) {
+        LOG_WARN("%s", "HUD failed to initialize; disabled");
+        hud_cleanup(state);
+        state->hud = false;
+    }
+
+    select_render_mode(state);
     LOG_DEBUG(state, "%s", "OpenGL subsystem initialization completed successfully");
     return true;
 }
 
 void cleanup_opengl(struct glwall_state *state) {
     LOG_DEBUG(state, "%s", "OpenGL subsystem cleanup initiated");
+    gl_alloc_log_report(state);
 
     cleanup_audio(state);
 
+    hud_cleanup(state);
     pipeline_cleanup(state);
 
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        render_target_destroy(&output->dynres_target, &state->gpu_mem);
+        gpu_timer_destroy(&output->gpu_timer);
+        gpu_timer_destroy(&output->frame_timer);
+        particles_destroy(&output->particles, &state->gpu_mem);
+        capture_cleanup_output(output);
+        snapshot_discard_readback(output);
+        render_target_destroy(&output->checker_targets[0], &state->gpu_mem);
+        render_target_destroy(&output->checker_targets[1], &state->gpu_mem);
+        render_target_destroy(&output->tile_target, &state->gpu_mem);
+        render_target_destroy(&output->share_target, &state->gpu_mem);
+        render_target_destroy(&output->keyframe_targets[0], &state->gpu_mem);
+        render_target_destroy(&output->keyframe_targets[1], &state->gpu_mem);
+        output->keyframe_count = 0;
+        output->share_frame_valid = false;
+    }
+
+    if (state->checker_resolve_program) {
+        glDeleteProgram(state->checker_resolve_program);
+        state->checker_resolve_program = 0;
+    }
+    if (state->keyframe_blend_program) {
+        glDeleteProgram(state->keyframe_blend_program);
+        state->keyframe_blend_program = 0;
+    }
+
     if (state->source_image_texture) {
-        glDeleteTextures(1, &state->source_image_texture);
+        gl_alloc_delete_textures(&state->gpu_mem, 1, &state->source_image_texture);
         state->source_image_texture = 0;
     }
 
-    if (state->shader_program) {
-        glDeleteProgram(state->shader_program);
-    }
+    user_program_destroy(&state->user_program);
+    free(state->user_vert_src);
+    free(state->user_frag_src);
+    state->user_vert_src = NULL;
+    state->user_frag_src = NULL;
     state->current_program = 0;
     if (state->vao) {
         glDeleteVertexArrays(1, &state->vao);
     }
     if (state->ubo_state) {
-        glDeleteBuffers(1, &state->ubo_state);
+        gl_alloc_delete_buffers(&state->gpu_mem, 1, &state->ubo_state);
         state->ubo_state = 0;
     }
     if (state->pass_ubo) {
-        glDeleteBuffers(1, &state->pass_ubo);
+        gl_alloc_delete_buffers(&state->gpu_mem, 1, &state->pass_ubo);
         state->pass_ubo = 0;
     }
+    gpu_mem_cleanup(&state->gpu_mem);
+}
+
+static void fill_frame_params(struct glwall_output *output, int32_t width_px, int32_t height_px,
+                              float shader_time, float time_delta, int current_frame,
+                              struct glwall_frame_params *params) {
+    struct glwall_state *state = output->state;
+    params->width_px = width_px;
+    params->height_px = height_px;
+    params->logical_width = output->logical_width;
+    params->logical_height = output->logical_height;
+    params->time_sec = shader_time;
+    params->time_delta = time_delta;
+    params->frame = current_frame;
+    params->ubo = state->ubo_state;
+    params->program = &state->user_program;
+    params->audio_texture = state->audio.texture;
+    params->pointer.output = state->pointer_output;
+    params->pointer.global = state->input_impl != NULL || state->pointer_global;
+    params->pointer.x = state->pointer_x;
+    params->pointer.y = state->pointer_y;
+    params->pointer.down_x = state->pointer_down_x;
+    params->pointer.down_y = state->pointer_down_y;
+    params->pointer.down = state->pointer_down;
+}
+
+void render_single_shader(struct glwall_output *output, const struct glwall_frame_params *params) {
+    struct glwall_state *state = output->state;
+    int32_t width_px = params->width_px;
+    int32_t height_px = params->height_px;
+    float shader_time = params->time_sec;
+    float time_delta = params->time_delta;
+    int current_frame = params->frame;
+
+    struct glwall_user_program *program = params->program;
+
+    if (program != &state->user_program) {
+        glUseProgram(program->program);
+    } else if (state->current_program != program->program) {
+        glUseProgram(program->program);
+        state->current_program = program->program;
+    }
+
+    if (program->loc_time != -1) {
+        glUniform1f(program->loc_time, shader_time);
+    }
+    if (program->loc_time_delta != -1) {
+        glUniform1f(program->loc_time_delta, time_delta);
+    }
+    if (program->loc_frame != -1) {
+        glUniform1i(program->loc_frame, current_frame);
+    }
+
+    if (program->resolution_w != width_px || program->resolution_h != height_px) {
+        if (program->loc_resolution != -1) {
+            glUniform3f(program->loc_resolution, (float)width_px, (float)height_px, 1.0f);
+        }
+        if (program->loc_resolution_vec2 != -1) {
+            glUniform2f(program->loc_resolution_vec2, (float)width_px, (float)height_px);
+        }
+        program->resolution_w = width_px;
+        program->resolution_h = height_px;
+    }
+
+    float mx = 0.0f, my = 0.0f, mz = 0.0f, mw = 0.0f;
+    const struct glwall_pointer_snapshot *pointer = &params->pointer;
+    bool mouse_needed = (state->shader_needs & GLWALL_NEED_MOUSE) != 0;
+    if (mouse_needed && (pointer->global || pointer->output == output)) {
+        float sx = params->logical_width > 0 ? (float)width_px / (float)params->logical_width
+                                             : 1.0f;
+        float sy = params->logical_height > 0 ? (float)height_px / (float)params->logical_height
+                                              : 1.0f;
+        mx = (float)pointer->x * sx;
+        my = (float)(height_px - 1) - (float)pointer->y * sy;
+        if (pointer->down) {
+            mz = (float)pointer->down_x * sx;
+            mw = (float)(height_px - 1) - (float)pointer->down_y * sy;
+        }
+    }
+    if (program->loc_mouse != -1) {
+        glUniform4f(program->loc_mouse, mx, my, mz, mw);
+    }
+    if (program->loc_mouse_vec2 != -1) {
+        glUniform2f(program->loc_mouse_vec2, mx, my);
+    }
+
+    if (params->ubo) {
+        float ubo_data[12];
+        ubo_data[0] = (float)width_px;
+        ubo_data[1] = (float)height_px;
+        ubo_data[2] = 1.0f;
+        ubo_data[3] = 0.0f;
+
+        ubo_data[4] = shader_time;
+        ubo_data[5] = time_delta;
+        ubo_data[6] = (float)current_frame;
+        ubo_data[7] = 0.0f;
+
+        ubo_data[8] = mx;
+        ubo_data[9] = my;
+        ubo_data[10] = mz;
+        ubo_data[11] = mw;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, params->ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ubo_data), ubo_data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    if (state->audio_enabled && state->audio.backend_ready) {
+        if (params->audio_texture != 0) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, params->audio_texture);
+        }
+    }
+
+    int32_t vertex_count = state->vertex_budget_ms > 0.0f ? output->vertex_budget.count
+                                                          : state->vertex_count;
+    if (program->loc_vertex_count != -1 && state->allow_vertex_shaders) {
+        glUniform1f(program->loc_vertex_count, (float)vertex_count);
+    }
+
+    assert(width_px > 0 && height_px > 0);
+    LOG_DEBUG(state,
+              "Render cycle: shader uniforms set (iTime: %.2f, iTimeDelta: %.4f, iFrame: %d, "
+              "iResolution: %d x %d x 1.0)",
+              shader_time, time_delta, current_frame, width_px, height_px);
+
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (state->particle_state) {
+        if (particles_ensure(&output->particles, &state->gpu_mem, output->output_name,
+                             state->vertex_count)) {
+            particles_draw(&output->particles, state->vertex_draw_mode, vertex_count);
+        } else {
+            LOG_ERROR("%s", "Memory allocation failed: insufficient memory for particle state");
+        }
+    } else if (state->allow_vertex_shaders && state->vertex_shader_path) {
+        glDrawArrays(state->vertex_draw_mode, 0, vertex_count);
+    } else {
+
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    if (state->debug) {
+        GLenum err;
+        if ((err = glGetError()) != GL_NO_ERROR) {
+            LOG_ERROR("OpenGL subsystem error: render error detected (error code: 0x%x)", err);
+        }
+    }
+}
+
+static void select_vertex_count(struct glwall_output *output) {
+    double gpu_ms;
+    while (gpu_timer_poll(&output->gpu_timer, &gpu_ms)) {
+        if (vertex_budget_update(&output->vertex_budget, gpu_ms)) {
+            LOG_DEBUG(output->state,
+                      "Vertex budget: output %u draws %d vertices (GPU %.2f ms, budget %.2f ms)",
+                      output->output_name, output->vertex_budget.count,
+                      output->vertex_budget.avg_ms, output->vertex_budget.budget_ms);
+        }
+    }
+}
+
+static bool select_dynres_target(struct glwall_output *output, int32_t *width_px,
+                                 int32_t *height_px) {
+    struct glwall_state *state = output->state;
+
+    double gpu_ms;
+    if (gpu_timer_poll(&output->gpu_timer, &gpu_ms) && dynres_update(&output->dynres, gpu_ms)) {
+        LOG_DEBUG(state, "Dynamic resolution: output %u scale %.3f (GPU %.2f ms, budget %.2f ms)",
+                  output->output_name, output->dynres.scale, output->dynres.avg_ms,
+                  output->dynres.budget_ms);
+    }
+
+    float scale = output->dynres.scale;
+    if (scale == 1.0f)
+        return false;
+
+    int32_t w = (int32_t)lroundf((float)output->width_px * scale);
+    int32_t h = (int32_t)lroundf((float)output->height_px * scale);
+    w = w > 0 ? w : 1;
+    h = h > 0 ? h : 1;
+    if (!render_target_ensure(&output->dynres_target, &state->gpu_mem, output->output_name, w,
+                              h)) {
+        LOG_WARN("Dynamic resolution: offscreen target unavailable for output %u; disabled",
+                 output->output_name);
+        dynres_init(&output->dynres, 0.0f, 1.0f, 1.0f);
+        return false;
+    }
+    *width_px = w;
+    *height_px = h;
+    return true;
+}
+
+static bool select_checker_target(struct glwall_output *output, int32_t *viewport_w) {
+    struct glwall_state *state = output->state;
+    int32_t half_w = (output->width_px + 1) / 2;
+    int32_t height = output->height_px;
+
+    for (int i = 0; i < 2; i++) {
+        struct glwall_render_target *target = &output->checker_targets[i];
+        if (target->width_px == half_w && target->height_px == height)
+            continue;
+        output->checker_history_valid = false;
+        if (!render_target_ensure(target, &state->gpu_mem, output->output_name, half_w,
+                                  height)) {
+            LOG_WARN("Checkerboard: offscreen target unavailable for output %u; disabled",
+                     output->output_name);
+            state->checkerboard = false;
+            return false;
+        }
+    }
+
+    if (state->current_program != state->user_program.program) {
+        glUseProgram(state->user_program.program);
+        state->current_program = state->user_program.program;
+    }
+    if (state->loc_checker_parity != -1)
+        glUniform1i(state->loc_checker_parity, output->checker_parity);
+    *viewport_w = half_w;
+    return true;
+}
+
+static void resolve_checkerboard(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    int parity = output->checker_parity;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, output->width_px, output->height_px);
+    glDisable(GL_BLEND);
+
+    glUseProgram(state->checker_resolve_program);
+    state->current_program = state->checker_resolve_program;
+    glUniform1i(state->loc_checker_resolve_parity, parity);
+    glUniform1i(state->loc_checker_history_valid, output->checker_history_valid ? 1 : 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, output->checker_targets[parity ^ 1].tex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, output->checker_targets[parity].tex);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glEnable(GL_BLEND);
+    output->checker_parity = parity ^ 1;
+    output->checker_history_valid = true;
+}
+
+static bool select_keyframe(struct glwall_output *output, float now, int *slot, float *key_time,
+                            float *key_dt) {
+    struct glwall_state *state = output->state;
+    for (int i = 0; i < 2; i++) {
+        struct glwall_render_target *target = &output->keyframe_targets[i];
+        if (target->width_px == output->width_px && target->height_px == output->height_px)
+            continue;
+        output->keyframe_count = 0;
+        if (!render_target_ensure(target, &state->gpu_mem, output->output_name, output->width_px,
+                                  output->height_px)) {
+            LOG_WARN("Keyframes: offscreen target unavailable for output %u; disabled",
+                     output->output_name);
+            state->keyframe_fps = 0;
+            return false;
+        }
+    }
+
+    float period = 1.0f / (float)state->keyframe_fps;
+    int newest = output->keyframe_newest;
+    float newest_time = output->keyframe_time[newest];
+    if (output->keyframe_count > 0 &&
+        (newest_time + period <= now || now < output->keyframe_time[newest ^ 1]))
+        output->keyframe_count = 0;
+
+    if (output->keyframe_count == 0) {
+        *slot = newest ^ 1;
+        *key_time = now;
+        *key_dt = 0.0f;
+    } else if (output->keyframe_count == 1 || now >= newest_time) {
+        *slot = newest ^ 1;
+        *key_time = newest_time + period;
+        *key_dt = period;
+    } else {
+        *slot = -1;
+    }
+    return true;
+}
+
+static void blend_keyframes(struct glwall_output *output, float now) {
+    struct glwall_state *state = output->state;
+    int newest = output->keyframe_newest;
+    float t_old = output->keyframe_time[newest ^ 1];
+    float t_new = output->keyframe_time[newest];
+    float mix = 1.0f;
+    if (output->keyframe_count > 1 && t_new > t_old) {
+        mix = (now - t_old) / (t_new - t_old);
+        mix = mix < 0.0f ? 0.0f : (mix > 1.0f ? 1.0f : mix);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, output->width_px, output->height_px);
+    glDisable(GL_BLEND);
+
+    glUseProgram(state->keyframe_blend_program);
+    state->current_program = state->keyframe_blend_program;
+    glUniform1f(state->loc_keyframe_mix, mix);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, output->keyframe_targets[newest ^ 1].tex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, output->keyframe_targets[newest].tex);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glEnable(GL_BLEND);
+}
+
+static void finish_frame(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (state->hud || state->cooperative) {
+        gpu_timer_end(&output->frame_timer);
+        double gpu_ms;
+        while (gpu_timer_poll(&output->frame_timer, &gpu_ms)) {
+            hud_series_add(&output->hud_history.gpu_ms, (float)gpu_ms);
+            if (state->cooperative && contention_update(&output->contention, gpu_ms)) {
+                LOG_INFO("Cooperative mode: output %u renders at 1/%d rate (GPU %.2f ms, "
+                         "uncontended %.2f ms)",
+                         output->output_name, 1 << output->contention.level,
+                         output->contention.recent_ms, output->contention.baseline_ms);
+            }
+        }
+    }
+    snapshot_capture_if_due(output);
+    capture_frame(output);
+    hud_draw(output);
+    deep_pause_capture(output);
+}
+
+static void start_tiled_image(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+
+    double gpu_ms;
+    while (gpu_timer_poll(&output->gpu_timer, &gpu_ms)) {
+        double frame_ms = gpu_ms * output->tile_count;
+        if (output->tile_frame_ms > 0.0)
+            output->tile_frame_ms += 0.2 * (frame_ms - output->tile_frame_ms);
+        else
+            output->tile_frame_ms = frame_ms;
+    }
+
+    int tiles = (int)ceil(output->tile_frame_ms / (double)state->tile_budget_ms);
+    if (tiles < 1)
+        tiles = 1;
+    if (tiles > GLWALL_MAX_TILES)
+        tiles = GLWALL_MAX_TILES;
+    if (tiles > output->height_px)
+        tiles = output->height_px;
+    if (tiles != output->tile_count) {
+        LOG_DEBUG(state, "Tiled rendering: output %u uses %d tiles (frame %.2f ms, budget %.2f ms)",
+                  output->output_name, tiles, output->tile_frame_ms, state->tile_budget_ms);
+        output->tile_count = tiles;
+    }
+}
+
+static void render_next_tile(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    int32_t width = output->width_px;
+    int32_t height = output->height_px;
+
+    if (output->tile_target.width_px != width || output->tile_target.height_px != height)
+        output->tile_next = 0;
+    if (output->tile_next == 0) {
+        start_tiled_image(output);
+        if (!render_target_ensure(&output->tile_target, &state->gpu_mem, output->output_name,
+                                  width, height)) {
+            LOG_WARN("Tiled rendering: offscreen target unavailable for output %u; disabled",
+                     output->output_name);
+            state->tile_budget_ms = 0.0f;
+            return;
+        }
+    }
+
+    int tile = output->tile_next;
+    int32_t y0 = (int32_t)((int64_t)height * tile / output->tile_count);
+    int32_t y1 = (int32_t)((int64_t)height * (tile + 1) / output->tile_count);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, output->tile_target.fbo);
+    glViewport(0, 0, width, height);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, y0, width, y1 - y0);
+    gpu_timer_begin(&output->gpu_timer);
+    struct glwall_frame_params params;
+    fill_frame_params(output, width, height, output->tile_time_sec, output->tile_dt_sec,
+                      output->tile_frame, &params);
+    render_single_shader(output, &params);
+    gpu_timer_end(&output->gpu_timer);
+    glDisable(GL_SCISSOR_TEST);
+
+    output->tile_next = tile + 1;
+    if (output->tile_next < output->tile_count) {
+        glFlush();
+        scheduler_tile_rendered(output);
+        return;
+    }
+
+    output->tile_next = 0;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, output->tile_target.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    finish_frame(output);
+    presentation_request_feedback(output, output->tile_count + output->frame_divisor - 1);
+    eglSwapBuffers(state->egl_display, output->egl_surface);
+    LOG_DEBUG(state, "Render cycle: tiled image presented for output %u", output->output_name);
+    scheduler_frame_rendered(output);
+}
+
+static void blit_to_surface(struct glwall_output *output,
+                            const struct glwall_render_target *target) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target->fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target->width_px, target->height_px, 0, 0, output->width_px,
+                      output->height_px, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+static bool same_buffer_size(const struct glwall_output *a, const struct glwall_output *b) {
+    return a->configured && b->configured && a->width_px == b->width_px &&
+           a->height_px == b->height_px;
+}
+
+static struct glwall_output *find_share_leader(struct glwall_output *output) {
+    for (struct glwall_output *o = output->state->outputs; o && o != output; o = o->next) {
+        if (same_buffer_size(o, output))
+            return o;
+    }
+    return NULL;
+}
+
+static bool has_share_followers(struct glwall_output *output) {
+    for (struct glwall_output *o = output->next; o; o = o->next) {
+        if (same_buffer_size(o, output))
+            return true;
+    }
+    return false;
+}
+
+static bool present_shared_frame(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    struct glwall_output *leader = find_share_leader(output);
+    if (!leader || !leader->share_frame_valid ||
+        leader->share_target.width_px != output->width_px ||
+        leader->share_target.height_px != output->height_px)
+        return false;
+
+    output->frame_start_ns = monotonic_time_ns();
+    blit_to_surface(output, &leader->share_target);
+    finish_frame(output);
+    presentation_request_feedback(output, output->frame_divisor);
+    eglSwapBuffers(state->egl_display, output->egl_surface);
+    LOG_DEBUG(state, "Render cycle: output %u presented frame shared by output %u",
+              output->output_name, leader->output_name);
+    scheduler_frame_rendered(output);
+    return true;
+}
+
+static void present_interpolated_frame(struct glwall_output *output, float now) {
+    struct glwall_state *state = output->state;
+    blend_keyframes(output, now);
+    finish_frame(output);
+    presentation_request_feedback(output, output->frame_divisor);
+    eglSwapBuffers(state->egl_display, output->egl_surface);
+    LOG_DEBUG(state, "Render cycle: output %u presented an interpolated frame",
+              output->output_name);
+    scheduler_frame_rendered(output);
+}
+
+void dump_timing_if_requested(struct glwall_state *state) {
+    if (!glwall_dump_gpu_flag)
+        return;
+    glwall_dump_gpu_flag = 0;
+    presentation_log_stats(state);
+    gl_alloc_log_report(state);
+    if (!pipeline_is_active(state))
+        return;
+
+    char path[PATH_MAX];
+    const char *xdg_runtime = getenv("XDG_RUNTIME_DIR");
+    pid_t pid = getpid();
+    if (xdg_runtime && xdg_runtime[0] != '\0') {
+        snprintf(path, sizeof(path), "%s/glwall_gpu_timing.%d.log", xdg_runtime, (int)pid);
+    } else {
+        snprintf(path, sizeof(path), "/tmp/glwall_gpu_timing.%d.log", (int)pid);
+    }
+    pipeline_dump_gpu_timing(state, path);
+    LOG_INFO("GPU timing dump written to %s", path);
+}
+
+void render_offscreen(struct glwall_output *output, GLuint target_fbo, float time_sec,
+                      float dt_sec, int frame) {
+    struct glwall_state *state = output->state;
+    output->frame_start_ns = monotonic_time_ns();
+
+    glBindVertexArray(state->vao);
+    replay_begin_frame(state, &time_sec, &dt_sec, &frame);
+    update_audio_texture(state);
+    replay_end_frame(state);
+    glBindFramebuffer(GL_FRAMEBUFFER, target_fbo);
+    glViewport(0, 0, output->width_px, output->height_px);
+    if (pipeline_is_active(state)) {
+        pipeline_render_frame(output, target_fbo, output->width_px, output->height_px, time_sec,
+                              dt_sec, frame);
+    } else {
+        struct glwall_frame_params params;
+        fill_frame_params(output, output->width_px, output->height_px, time_sec, dt_sec, frame,
+                          &params);
+        render_single_shader(output, &params);
+    }
 }
 
 void render_frame(struct glwall_output *output) {
@@ -422,25 +1275,41 @@ void render_frame(struct glwall_output *output) {
         LOG_DEBUG(state, "Render cycle: skipping unconfigured output %u", output->output_name);
         return;
     }
+    if (output->render_thread) {
+        render_thread_request_redraw(output);
+        return;
+    }
 
     LOG_DEBUG(state, "Render cycle: rendering output %u (dimensions: %u x %u)", output->output_name,
               output->width_px, output->height_px);
 
-    if (state->kernel_input_enabled) {
+    if (state->input_impl) {
         poll_input_events(state);
     }
 
+    if (!deep_pause_resume(output))
+        return;
     eglMakeCurrent(state->egl_display, output->egl_surface, output->egl_surface,
                    state->egl_context);
 
     glBindVertexArray(state->vao);
+    if (state->hud || state->cooperative)
+        gpu_timer_begin(&output->frame_timer);
 
-    glViewport(0, 0, output->width_px, output->height_px);
+    if (state->output_sharing && present_shared_frame(output))
+        return;
 
-    struct timespec current_time;
-    clock_gettime(CLOCK_MONOTONIC, &current_time);
-    float time_sec = (current_time.tv_sec - state->start_time.tv_sec) +
-                     (current_time.tv_nsec - state->start_time.tv_nsec) / 1e9f;
+    bool tiled = state->tile_budget_ms > 0.0f;
+    if (tiled && output->tile_next > 0) {
+        output->frame_start_ns = monotonic_time_ns();
+        render_next_tile(output);
+        return;
+    }
+
+    output->frame_start_ns = monotonic_time_ns();
+    uint64_t start_ns = (uint64_t)state->start_time.tv_sec * 1000000000ULL +
+                        (uint64_t)state->start_time.tv_nsec;
+    float time_sec = (float)((double)(output->frame_start_ns - start_ns) / 1e9);
 
     float dt_real;
     if (state->frame_index == 0) {
@@ -450,192 +1319,115 @@ void render_frame(struct glwall_output *output) {
         dt_real = time_sec - state->last_time_sec;
     }
 
-    float min_dt = 0.0f;
-    switch (state->power_mode) {
-    case GLWALL_POWER_MODE_FULL:
-        min_dt = 0.0f;
-        break;
-    case GLWALL_POWER_MODE_THROTTLED:
-        min_dt = 1.0f / 30.0f;
-        break;
-    case GLWALL_POWER_MODE_PAUSED:
-        min_dt = 1.0f;
-        break;
-    default:
-        min_dt = 0.0f;
-        break;
-    }
-
-    bool do_update = (state->frame_index == 0) || (dt_real >= min_dt);
-    float time_delta = 0.0f;
-    if (do_update) {
-        state->logical_time_sec += dt_real;
-        time_delta = dt_real;
-        state->last_time_sec = time_sec;
-        state->frame_index++;
-    }
+    state->logical_time_sec += dt_real;
+    float time_delta = dt_real;
+    state->last_time_sec = time_sec;
+    state->frame_index++;
 
     float shader_time = state->logical_time_sec;
     int current_frame = state->frame_index;
 
-    if (do_update) {
-        update_audio_texture(state);
+    replay_begin_frame(state, &shader_time, &time_delta, &current_frame);
+    update_audio_texture(state);
+    replay_end_frame(state);
+
+    if (tiled) {
+        output->tile_time_sec = shader_time;
+        output->tile_dt_sec = time_delta;
+        output->tile_frame = current_frame;
+        render_next_tile(output);
+        if (state->tile_budget_ms > 0.0f)
+            return;
+    }
+
+    float display_time = shader_time;
+    int key_slot = -1;
+    float key_time, key_dt;
+    bool keyed = state->keyframe_fps > 0 &&
+                 select_keyframe(output, display_time, &key_slot, &key_time, &key_dt);
+    if (keyed && key_slot < 0) {
+        present_interpolated_frame(output, display_time);
+        dump_timing_if_requested(state);
+        return;
+    }
+    if (keyed) {
+        shader_time = key_time;
+        time_delta = key_dt;
     }
 
+    bool dynres = output->dynres.budget_ms > 0.0f;
+    bool vertex_budget = state->vertex_budget_ms > 0.0f;
+    if (vertex_budget)
+        select_vertex_count(output);
+    int32_t render_w = output->width_px;
+    int32_t render_h = output->height_px;
+    int32_t viewport_w = render_w;
+    GLuint target_fbo = 0;
+    bool checker = state->checkerboard && select_checker_target(output, &viewport_w);
+    bool scaled = !checker && dynres && select_dynres_target(output, &render_w, &render_h);
+    bool shared = !checker && !scaled && state->output_sharing && !find_share_leader(output) &&
+                  has_share_followers(output) &&
+                  render_target_ensure(&output->share_target, &state->gpu_mem,
+                                       output->output_name, render_w, render_h);
+    if (checker) {
+        target_fbo = output->checker_targets[output->checker_parity].fbo;
+    } else if (scaled) {
+        target_fbo = output->dynres_target.fbo;
+        viewport_w = render_w;
+    } else if (shared) {
+        target_fbo = output->share_target.fbo;
+    } else if (keyed) {
+        target_fbo = output->keyframe_targets[key_slot].fbo;
+    }
+
+    if (dynres || vertex_budget)
+        gpu_timer_begin(&output->gpu_timer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target_fbo);
+    glViewport(0, 0, viewport_w, render_h);
+
     if (pipeline_is_active(state)) {
-        if (do_update) {
-        }
         if (state->profiling_enabled) {
             struct timespec t0, t1;
             clock_gettime(CLOCK_MONOTONIC, &t0);
-            pipeline_render_frame(output, shader_time, time_delta, current_frame);
+            pipeline_render_frame(output, target_fbo, render_w, render_h, shader_time, time_delta,
+                                  current_frame);
             clock_gettime(CLOCK_MONOTONIC, &t1);
             double ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
             state->profiling_last_frame_ms = ms;
             LOG_INFO("Pipeline frame CPU time: %.3f ms", ms);
         } else {
-            pipeline_render_frame(output, shader_time, time_delta, current_frame);
+            pipeline_render_frame(output, target_fbo, render_w, render_h, shader_time, time_delta,
+                                  current_frame);
         }
-
-        eglSwapBuffers(state->egl_display, output->egl_surface);
-        LOG_DEBUG(state, "Render cycle: buffer swap completed for output %u", output->output_name);
-
-        struct wl_callback *cb = wl_surface_frame(output->wl_surface);
-        wl_callback_add_listener(cb, &frame_listener, output);
-        wl_surface_commit(output->wl_surface);
-        /* If an external signal requested a GPU timing dump, perform it now from the main
-         * thread and write results to a file for later inspection. */
-        if (glwall_dump_gpu_flag) {
-            char path[PATH_MAX];
-            const char *xdg_runtime = getenv("XDG_RUNTIME_DIR");
-            pid_t pid = getpid();
-            if (xdg_runtime && xdg_runtime[0] != '\0') {
-                snprintf(path, sizeof(path), "%s/glwall_gpu_timing.%d.log", xdg_runtime, (int)pid);
-            } else {
-                snprintf(path, sizeof(path), "/tmp/glwall_gpu_timing.%d.log", (int)pid);
-            }
-            pipeline_dump_gpu_timing(state, path);
-            LOG_INFO("GPU timing dump written to %s", path);
-            glwall_dump_gpu_flag = 0;
-        }
-        return;
-    }
-
-    if (state->current_program != state->shader_program) {
-        glUseProgram(state->shader_program);
-        state->current_program = state->shader_program;
-    }
-
-    if (!state->ubo_state) {
-        if (state->loc_time != -1) {
-            glUniform1f(state->loc_time, shader_time);
-        }
-        if (state->loc_time_delta != -1) {
-            glUniform1f(state->loc_time_delta, time_delta);
-        }
-        if (state->loc_frame != -1) {
-            glUniform1i(state->loc_frame, current_frame);
-        }
-    }
-
-    if (output->loc_resolution_last_updated == 0 || output->last_resolution_w != output->width_px ||
-        output->last_resolution_h != output->height_px) {
-        if (!state->ubo_state) {
-            if (state->loc_resolution != -1) {
-                glUniform3f(state->loc_resolution, (float)output->width_px,
-                            (float)output->height_px, 1.0f);
-            }
-            if (state->loc_resolution_vec2 != -1) {
-                glUniform2f(state->loc_resolution_vec2, (float)output->width_px,
-                            (float)output->height_px);
-            }
-        }
-        output->last_resolution_w = output->width_px;
-        output->last_resolution_h = output->height_px;
-        output->loc_resolution_last_updated = 1;
-    }
-
-    if (state->loc_mouse != -1 || state->loc_mouse_vec2 != -1) {
-        float mx = 0.0f, my = 0.0f, mz = 0.0f, mw = 0.0f;
-
-        if (state->kernel_input_enabled || state->pointer_output == output) {
-            mx = (float)state->pointer_x;
-            my = (float)(output->height_px - 1) - (float)state->pointer_y;
-            if (state->pointer_down) {
-                mz = (float)state->pointer_down_x;
-                mw = (float)(output->height_px - 1) - (float)state->pointer_down_y;
-            }
-        }
-        if (!state->ubo_state) {
-            if (state->loc_mouse != -1) {
-                glUniform4f(state->loc_mouse, mx, my, mz, mw);
-            }
-            if (state->loc_mouse_vec2 != -1) {
-                glUniform2f(state->loc_mouse_vec2, mx, my);
-            }
-        }
-        if (state->ubo_state) {
-            float ubo_data[12];
-            ubo_data[0] = (float)output->width_px;
-            ubo_data[1] = (float)output->height_px;
-            ubo_data[2] = 1.0f;
-            ubo_data[3] = 0.0f;
-
-            ubo_data[4] = shader_time;
-            ubo_data[5] = time_delta;
-            ubo_data[6] = (float)current_frame;
-            ubo_data[7] = 0.0f;
-
-            ubo_data[8] = mx;
-            ubo_data[9] = my;
-            ubo_data[10] = mz;
-            ubo_data[11] = mw;
-
-            glBindBuffer(GL_UNIFORM_BUFFER, state->ubo_state);
-            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ubo_data), ubo_data);
-            glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        }
-    }
-
-    if (state->audio_enabled && state->audio.backend_ready) {
-        if (state->audio.texture != 0) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, state->audio.texture);
-        }
-    }
-
-    if (state->loc_vertex_count != -1 && state->allow_vertex_shaders) {
-        glUniform1f(state->loc_vertex_count, (float)state->vertex_count);
-    }
-
-    assert(output->width_px > 0 && output->height_px > 0);
-    LOG_DEBUG(state,
-              "Render cycle: shader uniforms set (iTime: %.2f, iTimeDelta: %.4f, iFrame: %d, "
-              "iResolution: %d x %d x 1.0)",
-              shader_time, time_delta, current_frame, output->width_px, output->height_px);
-
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    if (state->allow_vertex_shaders && state->vertex_shader_path) {
-        glDrawArrays(state->vertex_draw_mode, 0, state->vertex_count);
     } else {
-
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        struct glwall_frame_params params;
+        fill_frame_params(output, render_w, render_h, shader_time, time_delta, current_frame,
+                          &params);
+        render_single_shader(output, &params);
     }
 
-    if (state->debug) {
-        GLenum err;
-        if ((err = glGetError()) != GL_NO_ERROR) {
-            LOG_ERROR("OpenGL subsystem error: render error detected (error code: 0x%x)", err);
-        }
+    if (checker)
+        resolve_checkerboard(output);
+    if (scaled)
+        blit_to_surface(output, &output->dynres_target);
+    if (shared)
+        blit_to_surface(output, &output->share_target);
+    output->share_frame_valid = shared;
+    if (dynres || vertex_budget)
+        gpu_timer_end(&output->gpu_timer);
+    if (keyed) {
+        output->keyframe_time[key_slot] = shader_time;
+        output->keyframe_newest = key_slot;
+        output->keyframe_count = output->keyframe_count < 2 ? output->keyframe_count + 1 : 2;
+        blend_keyframes(output, display_time);
     }
 
+    finish_frame(output);
+    presentation_request_feedback(output, output->frame_divisor);
     eglSwapBuffers(state->egl_display, output->egl_surface);
     LOG_DEBUG(state, "Render cycle: buffer swap completed for output %u", output->output_name);
 
-    struct wl_callback *cb = wl_surface_frame(output->wl_surface);
-    wl_callback_add_listener(cb, &frame_listener, output);
-    wl_surface_commit(output->wl_surface);
-}
\ No newline at end of file
+    scheduler_frame_rendered(output);
+    dump_timing_if_requested(state);
+}
@@ -2,8 +2,38 @@
 
 #include "state.h"
 
+struct glwall_frame_params {
+    int32_t width_px;
+    int32_t height_px;
+    int32_t logical_width;
+    int32_t logical_height;
+    float time_sec;
+    float time_delta;
+    int frame;
+    GLuint ubo;
+    struct glwall_user_program *program;
+    GLuint audio_texture;
+    struct glwall_pointer_snapshot pointer;
+};
+
 bool init_opengl(struct glwall_state *state);
 
+void activate_needed_subsystems(struct glwall_state *state);
+
 void cleanup_opengl(struct glwall_state *state);
 
+GLuint create_shader_program(struct glwall_state *state, const char *vert_src,
+                             const char *frag_src);
+
+bool user_program_link_copy(struct glwall_state *state, struct glwall_user_program *copy);
+
+void user_program_destroy(struct glwall_user_program *user);
+
+void render_single_shader(struct glwall_output *output, const struct glwall_frame_params *params);
+
+void render_offscreen(struct glwall_output *output, GLuint target_fbo, float time_sec,
+                      float dt_sec, int frame);
+
 void render_frame(struct glwall_output *output);
+
+void dump_timing_if_requested(struct glwall_state *state);
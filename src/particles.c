@@ -0,0 +1,66 @@
+#include "particles.h"
+#include "gl_alloc.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define PARTICLE_STATE_SIZE (4 * sizeof(GLfloat))
+
+bool particles_ensure(struct glwall_particles *particles, struct glwall_gpu_mem *mem,
+                      uint32_t owner, int32_t capacity) {
+    assert(particles != NULL);
+    assert(capacity > 0);
+
+    if (particles->buffers[0] && particles->capacity == capacity)
+        return true;
+
+    void *zeros = calloc((size_t)capacity, PARTICLE_STATE_SIZE);
+    if (!zeros)
+        return false;
+
+    if (!particles->buffers[0])
+        glGenBuffers(2, particles->buffers);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, particles->buffers[i]);
+        gl_alloc_buffer_data(mem, GLWALL_GPU_MEM_PARTICLES, owner, GL_ARRAY_BUFFER,
+                             particles->buffers[i], (GLsizeiptr)capacity * PARTICLE_STATE_SIZE,
+                             zeros, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    free(zeros);
+
+    particles->read = 0;
+    particles->capacity = capacity;
+    return true;
+}
+
+void particles_draw(struct glwall_particles *particles, GLenum mode, int32_t count) {
+    assert(particles != NULL);
+    assert(count <= particles->capacity);
+
+    int write = 1 - particles->read;
+    glBindBuffer(GL_ARRAY_BUFFER, particles->buffers[particles->read]);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particles->buffers[write]);
+    glBeginTransformFeedback(mode);
+    glDrawArrays(mode, 0, count);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+    glDisableVertexAttribArray(0);
+    particles->read = write;
+}
+
+void particles_destroy(struct glwall_particles *particles, struct glwall_gpu_mem *mem) {
+    assert(particles != NULL);
+
+    if (particles->buffers[0])
+        gl_alloc_delete_buffers(mem, 2, particles->buffers);
+    particles->buffers[0] = 0;
+    particles->buffers[1] = 0;
+    particles->read = 0;
+    particles->capacity = 0;
+}
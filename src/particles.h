@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <GL/glew.h>
+
+#include "gpu_mem.h"
+
+#define GLWALL_PARTICLE_STATE_IN "particleState"
+#define GLWALL_PARTICLE_STATE_OUT "nextParticleState"
+
+struct glwall_particles {
+    GLuint buffers[2];
+    int read;
+    int32_t capacity;
+};
+
+bool particles_ensure(struct glwall_particles *particles, struct glwall_gpu_mem *mem,
+                      uint32_t owner, int32_t capacity);
+
+void particles_draw(struct glwall_particles *particles, GLenum mode, int32_t count);
+
+void particles_destroy(struct glwall_particles *particles, struct glwall_gpu_mem *mem);
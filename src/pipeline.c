@@ -2,7 +2,9 @@
 
 #include "pipeline.h"
 
+#include "gl_alloc.h"
 #include "image.h"
+#include "reflect.h"
 #include "slang_process.h"
 #include "utils.h"
 
@@ -65,9 +67,13 @@ struct glwall_pass {
     GLint loc_OriginalSize;
     GLint loc_FinalViewportSize;
     GLint loc_MVP;
+    bool custom_vertex;
     GLuint time_query;
+    bool time_query_pending;
     double gpu_time_accum;
     int gpu_time_samples;
+    double last_gpu_ms;
+    bool has_last_gpu_ms;
 
     int param_count;
     struct glwall_param_default params[GLWALL_MAX_PARAMETERS];
@@ -383,6 +389,21 @@ static const char *quad_vertex_shader_src = "#version 330 core\n"
                                             "  vTexCoord = uv[gl_VertexID];\n"
                                             "}\n";
 
+#define RA_PASS_BLOCK_SRC                                                                          \
+    "layout(std140, binding = 1) uniform glwall_pass_block {\n"                                    \
+    "  vec4 pass_SourceSize;\n"                                                                    \
+    "  vec4 pass_OriginalSize;\n"                                                                  \
+    "  vec4 pass_OutputSize;\n"                                                                    \
+    "  vec4 pass_FinalViewportSize;\n"                                                             \
+    "};\n"                                                                                         \
+    "#define SourceSize pass_SourceSize\n"                                                         \
+    "#define OriginalSize pass_OriginalSize\n"                                                     \
+    "#define OutputSize pass_OutputSize\n"                                                         \
+    "#define FinalViewportSize pass_FinalViewportSize\n"                                           \
+    "uniform int FrameCount;\n"                                                                    \
+    "uniform float FrameTime;\n"                                                                   \
+    "uniform float FrameDirection;\n"
+
 static const char *ra_fragment_header =
     "#version 330 core\n"
     "in vec2 vTexCoord;\n"
@@ -394,20 +415,26 @@ static const char *ra_fragment_header =
     "#define gl_FragColor FragColor\n"
     "uniform sampler2D Source;\n"
     "uniform sampler2D Original;\n"
-    "/* Per-pass state block: mapped into existing uniform names via macros */\n"
-    "layout(std140, binding = 1) uniform glwall_pass_block {\n"
-    "  vec4 pass_SourceSize;\n"
-    "  vec4 pass_OriginalSize;\n"
-    "  vec4 pass_OutputSize;\n"
-    "  vec4 pass_FinalViewportSize;\n"
-    "};\n"
-    "#define SourceSize pass_SourceSize\n"
-    "#define OriginalSize pass_OriginalSize\n"
-    "#define OutputSize pass_OutputSize\n"
-    "#define FinalViewportSize pass_FinalViewportSize\n"
-    "uniform int FrameCount;\n"
-    "uniform float FrameTime;\n"
-    "uniform float FrameDirection;\n";
+    "/* Per-pass state block: mapped into existing uniform names via macros */\n" RA_PASS_BLOCK_SRC;
+
+static const char *ra_vertex_header =
+    "#version 330 core\n"
+    "const vec2 glwall_quad_uv[4] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), "
+    "vec2(1.0, 1.0));\n"
+    "#define Position vec4(glwall_quad_uv[gl_VertexID], 0.0, 1.0)\n"
+    "#define TexCoord glwall_quad_uv[gl_VertexID]\n"
+    "#define COMPAT_VARYING out\n"
+    "#define COMPAT_ATTRIBUTE in\n"
+    "#define COMPAT_TEXTURE texture\n"
+    "uniform sampler2D Source;\n"
+    "uniform sampler2D Original;\n" RA_PASS_BLOCK_SRC;
+
+static const GLfloat ra_mvp_ortho[16] = {
+    2.0f,  0.0f,  0.0f,  0.0f,
+    0.0f,  2.0f,  0.0f,  0.0f,
+    0.0f,  0.0f,  -1.0f, 0.0f,
+    -1.0f, -1.0f, 0.0f,  1.0f,
+};
 
 static GLuint compile_shader(struct glwall_state *state, GLenum type, const char *source) {
     GLuint shader = glCreateShader(type);
@@ -507,7 +534,8 @@ static bool load_texture_png(struct glwall_state *state, const char *path, GLuin
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.rgba);
+    gl_alloc_tex_image_2d(&state->gpu_mem, GLWALL_GPU_MEM_LUT, GLWALL_GPU_MEM_SHARED, tex, GL_RGBA8,
+                          w, h, GL_RGBA, GL_UNSIGNED_BYTE, img.rgba);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     free_glwall_image(&img);
@@ -515,18 +543,16 @@ static bool load_texture_png(struct glwall_state *state, const char *path, GLuin
     *out_tex = tex;
     *out_w = w;
     *out_h = h;
-
-    (void)state;
     return true;
 }
 
-static void delete_pass_resources(struct glwall_pass *p) {
+static void delete_pass_resources(struct glwall_pipeline *pl, struct glwall_pass *p) {
     if (p->program)
         glDeleteProgram(p->program);
     if (p->fbo)
         glDeleteFramebuffers(1, &p->fbo);
     if (p->tex)
-        glDeleteTextures(1, &p->tex);
+        gl_alloc_delete_textures(&pl->state->gpu_mem, 1, &p->tex);
     if (p->time_query)
         glDeleteQueries(1, &p->time_query);
 
@@ -543,19 +569,20 @@ static void delete_named_textures(struct glwall_pipeline *pl) {
         free(pl->named_textures[i].name);
         free(pl->named_textures[i].path);
         if (pl->named_textures[i].tex)
-            glDeleteTextures(1, &pl->named_textures[i].tex);
+            gl_alloc_delete_textures(&pl->state->gpu_mem, 1, &pl->named_textures[i].tex);
     }
     pl->named_texture_count = 0;
 }
 
-static void ensure_pass_target(struct glwall_pass *p, int w, int h) {
+static void ensure_pass_target(struct glwall_pipeline *pl, struct glwall_pass *p, int w, int h) {
     if (p->tex && p->out_w == w && p->out_h == h && p->fbo)
         return;
 
+    struct glwall_gpu_mem *mem = &pl->state->gpu_mem;
     if (p->fbo)
         glDeleteFramebuffers(1, &p->fbo);
     if (p->tex)
-        glDeleteTextures(1, &p->tex);
+        gl_alloc_delete_textures(mem, 1, &p->tex);
 
     p->out_w = w;
     p->out_h = h;
@@ -568,7 +595,8 @@ static void ensure_pass_target(struct glwall_pass *p, int w, int h) {
                     p->filter_linear ? GL_LINEAR : GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
                     p->filter_linear ? GL_LINEAR : GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gl_alloc_tex_image_2d(mem, GLWALL_GPU_MEM_PASS_TARGET, GLWALL_GPU_MEM_SHARED, p->tex, GL_RGBA8,
+                          w, h, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     glGenFramebuffers(1, &p->fbo);
@@ -713,6 +741,21 @@ static void pass_bind_common_samplers(struct glwall_pipeline *pl, struct glwall_
     pass_add_sampler(pl, p, "sound", unit++);
 }
 
+static char *build_pass_vertex_source(const char *raw) {
+    char *san = slang_process_vertex_to_gl330(raw);
+    if (!san)
+        return NULL;
+
+    char *vs_body = strip_version_directive(san);
+    free(san);
+    if (!vs_body)
+        return NULL;
+
+    char *vs_src = concat2(ra_vertex_header, vs_body);
+    free(vs_body);
+    return vs_src;
+}
+
 static bool build_pass_program(struct glwall_state *state, struct glwall_pipeline *pl,
                                struct glwall_pass *p, const char *shader_file_path) {
     char *raw = read_file(shader_file_path);
@@ -721,32 +764,54 @@ static bool build_pass_program(struct glwall_state *state, struct glwall_pipelin
         return false;
     }
 
+    char *vs_src = build_pass_vertex_source(raw);
+
     char *san = slang_process_to_gl330(raw);
     free(raw);
-    if (!san)
+    if (!san) {
+        free(vs_src);
         return false;
+    }
 
     record_param_defaults(p, san);
 
     char *fs_body = strip_version_directive(san);
     free(san);
-    if (!fs_body)
+    if (!fs_body) {
+        free(vs_src);
         return false;
+    }
 
     char *fs_src = concat2(ra_fragment_header, fs_body);
     free(fs_body);
-    if (!fs_src)
+    if (!fs_src) {
+        free(vs_src);
         return false;
+    }
 
-    GLuint prog = create_program(state, quad_vertex_shader_src, fs_src);
+    GLuint prog = 0;
+    if (vs_src) {
+        prog = create_program(state, vs_src, fs_src);
+        free(vs_src);
+        if (!prog) {
+            LOG_WARN("Vertex stage of '%s' failed to build; falling back to the built-in quad",
+                     shader_file_path);
+        }
+    }
+    p->custom_vertex = prog != 0;
+    if (!prog)
+        prog = create_program(state, quad_vertex_shader_src, fs_src);
     free(fs_src);
 
     if (!prog) {
         LOG_ERROR("Failed to build program for pass shader '%s'", shader_file_path);
         return false;
     }
+    LOG_DEBUG(state, "Pass shader '%s' linked (vertex stage: %s)", shader_file_path,
+              p->custom_vertex ? "preset" : "built-in");
 
     p->program = prog;
+    state->shader_needs |= reflect_program_needs(prog);
     pass_resolve_uniforms(p);
     pass_bind_common_samplers(pl, p);
 
@@ -756,6 +821,9 @@ static bool build_pass_program(struct glwall_state *state, struct glwall_pipelin
             glUniform1i(p->sampler_locs[si], p->sampler_units[si]);
         }
     }
+    if (p->loc_MVP != -1) {
+        glUniformMatrix4fv(p->loc_MVP, 1, GL_FALSE, ra_mvp_ortho);
+    }
     glUseProgram(0);
 
     if (p->time_query == 0) {
@@ -836,7 +904,7 @@ static void pipeline_free(struct glwall_pipeline *pl) {
         return;
 
     for (int i = 0; i < pl->pass_count; i++) {
-        delete_pass_resources(&pl->passes[i]);
+        delete_pass_resources(pl, &pl->passes[i]);
     }
     delete_named_textures(pl);
     free(pl);
@@ -978,6 +1046,23 @@ void pipeline_cleanup(struct glwall_state *state) {
     }
 }
 
+void pipeline_release_targets(struct glwall_state *state) {
+    struct glwall_pipeline *pl = state->pipeline;
+    if (!pl)
+        return;
+    for (int i = 0; i < pl->pass_count; i++) {
+        struct glwall_pass *p = &pl->passes[i];
+        if (p->fbo)
+            glDeleteFramebuffers(1, &p->fbo);
+        if (p->tex)
+            gl_alloc_delete_textures(&state->gpu_mem, 1, &p->tex);
+        p->fbo = 0;
+        p->tex = 0;
+    }
+    pl->last_viewport_w = 0;
+    pl->last_viewport_h = 0;
+}
+
 static void set_size_vec4(GLint loc, int w, int h) {
     if (loc == -1)
         return;
@@ -1029,7 +1114,7 @@ static void pipeline_prepare_alloc(struct glwall_pipeline *pl, int viewport_w, i
             out_h = 1;
 
         if (i != pl->pass_count - 1) {
-            ensure_pass_target(p, out_w, out_h);
+            ensure_pass_target(pl, p, out_w, out_h);
         }
 
         in_w = out_w;
@@ -1096,8 +1181,33 @@ static void bind_sampler_and_size(const struct glwall_state *state, struct glwal
     set_size_vec4(size_loc, w, h);
 }
 
-void pipeline_render_frame(struct glwall_output *output, float time_sec, float dt_sec,
-                           int frame_index) {
+static void collect_pass_time(const struct glwall_state *state, struct glwall_pass *p, int index) {
+    GLint available = 0;
+    glGetQueryObjectiv(p->time_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+    p->time_query_pending = false;
+
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(p->time_query, GL_QUERY_RESULT, &result);
+    double gpu_ms = (double)result / 1e6;
+    p->last_gpu_ms = gpu_ms;
+    p->has_last_gpu_ms = true;
+    if (!state->profiling_enabled)
+        return;
+    p->gpu_time_accum += gpu_ms;
+    p->gpu_time_samples += 1;
+    if (p->gpu_time_samples >= 60) {
+        double avg = p->gpu_time_accum / (double)p->gpu_time_samples;
+        LOG_INFO("Pipeline pass %d avg GPU time: %.3f ms (samples=%d)", index, avg,
+                 p->gpu_time_samples);
+        p->gpu_time_accum = 0.0;
+        p->gpu_time_samples = 0;
+    }
+}
+
+void pipeline_render_frame(struct glwall_output *output, GLuint target_fbo, int32_t target_w,
+                           int32_t target_h, float time_sec, float dt_sec, int frame_index) {
     assert(output);
     assert(output->state);
 
@@ -1107,7 +1217,7 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
 
     struct glwall_pipeline *pl = state->pipeline;
 
-    pipeline_prepare_alloc(pl, output->width_px, output->height_px);
+    pipeline_prepare_alloc(pl, target_w, target_h);
 
     GLuint original_tex = 0;
     int original_w = 1, original_h = 1;
@@ -1127,7 +1237,9 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, px);
+            gl_alloc_tex_image_2d(&state->gpu_mem, GLWALL_GPU_MEM_SOURCE_IMAGE,
+                                  GLWALL_GPU_MEM_SHARED, state->source_image_texture, GL_RGBA8, 1,
+                                  1, GL_RGBA, GL_UNSIGNED_BYTE, px);
             glBindTexture(GL_TEXTURE_2D, 0);
             state->source_image_width_px = 1;
             state->source_image_height_px = 1;
@@ -1149,13 +1261,13 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
         struct glwall_pass *p = &pl->passes[i];
 
         bool is_last = (i == pl->pass_count - 1);
-        int out_w = is_last ? output->width_px : p->out_w;
-        int out_h = is_last ? output->height_px : p->out_h;
+        int out_w = is_last ? target_w : p->out_w;
+        int out_h = is_last ? target_h : p->out_h;
 
-        int target_fbo = is_last ? 0 : (int)p->fbo;
-        if (target_fbo != prev_fbo) {
-            glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)target_fbo);
-            prev_fbo = target_fbo;
+        GLint pass_fbo = is_last ? (GLint)target_fbo : (GLint)p->fbo;
+        if (pass_fbo != prev_fbo) {
+            glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)pass_fbo);
+            prev_fbo = pass_fbo;
         }
 
         glViewport(0, 0, out_w, out_h);
@@ -1197,8 +1309,8 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
             pass_ubo_data[10] = ow2 > 0.0f ? 1.0f / ow2 : 0.0f;
             pass_ubo_data[11] = oh2 > 0.0f ? 1.0f / oh2 : 0.0f;
 
-            float vfw = (float)output->width_px;
-            float vfh = (float)output->height_px;
+            float vfw = (float)target_w;
+            float vfh = (float)target_h;
             pass_ubo_data[12] = vfw;
             pass_ubo_data[13] = vfh;
             pass_ubo_data[14] = vfw > 0.0f ? 1.0f / vfw : 0.0f;
@@ -1211,7 +1323,7 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
             set_size_vec4(p->loc_OutputSize, out_w, out_h);
             set_size_vec4(p->loc_SourceSize, src_w, src_h);
             set_size_vec4(p->loc_OriginalSize, original_w, original_h);
-            set_size_vec4(p->loc_FinalViewportSize, output->width_px, output->height_px);
+            set_size_vec4(p->loc_FinalViewportSize, target_w, target_h);
         }
 
         for (int pi = 0; pi < p->param_count; pi++) {
@@ -1230,43 +1342,56 @@ void pipeline_render_frame(struct glwall_output *output, float time_sec, float d
                                   original_h, i);
         }
 
-        if (state->profiling_enabled && p->time_query != 0) {
+        bool timed = (state->profiling_enabled || state->benchmark || state->hud) &&
+                     p->time_query != 0;
+        if (timed && p->time_query_pending && !state->benchmark)
+            collect_pass_time(state, p, i);
+        if (timed) {
             glBeginQuery(GL_TIME_ELAPSED, p->time_query);
         }
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        if (state->profiling_enabled && p->time_query != 0) {
+        if (timed) {
             glEndQuery(GL_TIME_ELAPSED);
-            GLint available = 0;
-            glGetQueryObjectiv(p->time_query, GL_QUERY_RESULT_AVAILABLE, &available);
-            if (available) {
-                GLuint64 result = 0;
-                glGetQueryObjectui64v(p->time_query, GL_QUERY_RESULT, &result);
-                double gpu_ms = (double)result / 1e6;
-                p->gpu_time_accum += gpu_ms;
-                p->gpu_time_samples += 1;
-                if (p->gpu_time_samples >= 60) {
-                    double avg = p->gpu_time_accum / (double)p->gpu_time_samples;
-                    LOG_INFO("Pipeline pass %d avg GPU time: %.3f ms (samples=%d)", i, avg,
-                             p->gpu_time_samples);
-                    p->gpu_time_accum = 0.0;
-                    p->gpu_time_samples = 0;
-                }
-            }
-
-            if (!is_last) {
-                src_tex = p->tex;
-                src_w = p->out_w;
-                src_h = p->out_h;
-            }
+            p->time_query_pending = true;
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!is_last) {
+            src_tex = p->tex;
+            src_w = p->out_w;
+            src_h = p->out_h;
+        }
     }
 
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
     glUseProgram(0);
     state->current_program = 0;
 }
 
+int pipeline_pass_count(const struct glwall_state *state) {
+    return pipeline_is_active(state) ? state->pipeline->pass_count : 0;
+}
+
+bool pipeline_pass_last_gpu_ms(const struct glwall_state *state, int pass, double *gpu_ms) {
+    if (pass < 0 || pass >= pipeline_pass_count(state))
+        return false;
+    const struct glwall_pass *p = &state->pipeline->passes[pass];
+    *gpu_ms = p->last_gpu_ms;
+    return p->has_last_gpu_ms;
+}
+
+bool pipeline_pass_gpu_ms(const struct glwall_state *state, int pass, double *gpu_ms) {
+    if (pass < 0 || pass >= pipeline_pass_count(state))
+        return false;
+    const struct glwall_pass *p = &state->pipeline->passes[pass];
+    if (p->time_query == 0)
+        return false;
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(p->time_query, GL_QUERY_RESULT, &result);
+    *gpu_ms = (double)result / 1e6;
+    return true;
+}
+
 void pipeline_dump_gpu_timing(struct glwall_state *state, const char *path) {
     if (!state || !state->pipeline || !path)
         return;
@@ -11,10 +11,18 @@ bool pipeline_init_from_preset(struct glwall_state *state, const char *preset_pa
 
 void pipeline_cleanup(struct glwall_state *state);
 
+void pipeline_release_targets(struct glwall_state *state);
+
 bool pipeline_is_active(const struct glwall_state *state);
 
-void pipeline_render_frame(struct glwall_output *output, float time_sec, float dt_sec,
-                           int frame_index);
+void pipeline_render_frame(struct glwall_output *output, GLuint target_fbo, int32_t target_w,
+                           int32_t target_h, float time_sec, float dt_sec, int frame_index);
+
+int pipeline_pass_count(const struct glwall_state *state);
+
+bool pipeline_pass_gpu_ms(const struct glwall_state *state, int pass, double *gpu_ms);
+
+bool pipeline_pass_last_gpu_ms(const struct glwall_state *state, int pass, double *gpu_ms);
 
 /* Dump aggregated GPU timings for all pipeline passes to `path`. Safe to call from
  * the main thread; does nothing if no pipeline is active. */
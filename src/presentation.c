@@ -0,0 +1,159 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "presentation.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "presentation-time-client-protocol.h"
+
+#define GLWALL_PRESENT_LOG_INTERVAL 600
+
+static void presentation_handle_clock_id(void *data, struct wp_presentation *presentation,
+                                         uint32_t clk_id) {
+    (void)presentation;
+    struct glwall_state *state = data;
+    state->presentation_clock = clk_id;
+    if (clk_id != CLOCK_MONOTONIC)
+        LOG_WARN("%s", "Presentation clock is not CLOCK_MONOTONIC; frame latency unavailable");
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+    .clock_id = presentation_handle_clock_id,
+};
+
+void presentation_attach(struct glwall_state *state, struct wp_presentation *presentation) {
+    state->presentation = presentation;
+    state->presentation_clock = CLOCK_MONOTONIC;
+    wp_presentation_add_listener(presentation, &presentation_listener, state);
+}
+
+static void log_output_stats(struct glwall_output *output) {
+    pthread_mutex_lock(&output->frame_stats_lock);
+    struct glwall_frame_stats stats = output->frame_stats;
+    pthread_mutex_unlock(&output->frame_stats_lock);
+    const struct glwall_frame_stats *st = &stats;
+    LOG_INFO("Frame timing: output %u presented %llu discarded %llu missed vblanks %llu "
+             "latency avg %.2f ms max %.2f ms jitter %.3f ms",
+             output->output_name, (unsigned long long)st->presented,
+             (unsigned long long)st->discarded, (unsigned long long)st->missed_vblanks,
+             st->latency_avg_ms, st->latency_max_ms, st->jitter_avg_ms);
+}
+
+static void release_pending(struct glwall_present_pending *pending) {
+    wp_presentation_feedback_destroy(pending->feedback);
+    pending->feedback = NULL;
+}
+
+static void feedback_handle_sync_output(void *data, struct wp_presentation_feedback *feedback,
+                                        struct wl_output *wl_output) {
+    (void)data;
+    (void)feedback;
+    (void)wl_output;
+}
+
+static void feedback_handle_presented(void *data, struct wp_presentation_feedback *feedback,
+                                      uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+                                      uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo,
+                                      uint32_t flags) {
+    (void)feedback;
+    struct glwall_present_pending *pending = data;
+    struct glwall_output *output = pending->output;
+    struct glwall_state *state = output->state;
+
+    uint64_t sec = ((uint64_t)tv_sec_hi << 32) | tv_sec_lo;
+    uint64_t present_ns = sec * 1000000000ULL + tv_nsec;
+    uint64_t seq = ((uint64_t)seq_hi << 32) | seq_lo;
+    bool seq_valid = (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC) && seq != 0;
+    uint64_t start_ns =
+        state->presentation_clock == CLOCK_MONOTONIC ? pending->render_start_ns : present_ns;
+
+    pthread_mutex_lock(&output->frame_stats_lock);
+    frame_stats_presented(&output->frame_stats, present_ns, seq, seq_valid, refresh, start_ns,
+                          pending->vblanks);
+    uint64_t presented = output->frame_stats.presented;
+    pthread_mutex_unlock(&output->frame_stats_lock);
+    release_pending(pending);
+
+    if (state->debug && presented % GLWALL_PRESENT_LOG_INTERVAL == 0)
+        log_output_stats(output);
+}
+
+static void feedback_handle_discarded(void *data, struct wp_presentation_feedback *feedback) {
+    (void)feedback;
+    struct glwall_present_pending *pending = data;
+    struct glwall_output *output = pending->output;
+    pthread_mutex_lock(&output->frame_stats_lock);
+    frame_stats_discarded(&output->frame_stats);
+    pthread_mutex_unlock(&output->frame_stats_lock);
+    release_pending(pending);
+}
+
+static const struct wp_presentation_feedback_listener feedback_listener = {
+    .sync_output = feedback_handle_sync_output,
+    .presented = feedback_handle_presented,
+    .discarded = feedback_handle_discarded,
+};
+
+void presentation_init_output(struct glwall_output *output) {
+    pthread_mutex_init(&output->frame_stats_lock, NULL);
+}
+
+void presentation_request_feedback(struct glwall_output *output, int32_t vblanks) {
+    assert(output != NULL);
+
+    presentation_request_feedback_on(output, output->state->presentation, output->frame_start_ns,
+                                     vblanks);
+}
+
+void presentation_request_feedback_on(struct glwall_output *output,
+                                      struct wp_presentation *presentation,
+                                      uint64_t render_start_ns, int32_t vblanks) {
+    assert(output != NULL);
+
+    struct glwall_state *state = output->state;
+    if (!presentation)
+        return;
+
+    struct glwall_present_pending *pending = NULL;
+    for (int i = 0; i < GLWALL_PRESENT_PENDING; i++) {
+        if (!output->present_pending[i].feedback) {
+            pending = &output->present_pending[i];
+            break;
+        }
+    }
+    if (!pending) {
+        LOG_DEBUG(state, "Frame timing: output %u has too many frames in flight; not tracked",
+                  output->output_name);
+        return;
+    }
+
+    pending->output = output;
+    pending->render_start_ns = render_start_ns;
+    pending->vblanks = state->render_once ? 0 : vblanks;
+    pending->feedback = wp_presentation_feedback(presentation, output->wl_surface);
+    wp_presentation_feedback_add_listener(pending->feedback, &feedback_listener, pending);
+}
+
+void presentation_log_stats(const struct glwall_state *state) {
+    if (!state->presentation) {
+        LOG_INFO("%s", "Frame timing: wp_presentation unavailable");
+        return;
+    }
+    for (struct glwall_output *output = state->outputs; output; output = output->next)
+        log_output_stats(output);
+}
+
+void presentation_discard_pending(struct glwall_output *output) {
+    for (int i = 0; i < GLWALL_PRESENT_PENDING; i++) {
+        if (output->present_pending[i].feedback)
+            release_pending(&output->present_pending[i]);
+    }
+}
+
+void presentation_cleanup_output(struct glwall_output *output) {
+    presentation_discard_pending(output);
+    pthread_mutex_destroy(&output->frame_stats_lock);
+}
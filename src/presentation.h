@@ -0,0 +1,21 @@
+#pragma once
+
+#include "state.h"
+
+struct wp_presentation;
+
+void presentation_attach(struct glwall_state *state, struct wp_presentation *presentation);
+
+void presentation_init_output(struct glwall_output *output);
+
+void presentation_request_feedback(struct glwall_output *output, int32_t vblanks);
+
+void presentation_request_feedback_on(struct glwall_output *output,
+                                      struct wp_presentation *presentation,
+                                      uint64_t render_start_ns, int32_t vblanks);
+
+void presentation_log_stats(const struct glwall_state *state);
+
+void presentation_discard_pending(struct glwall_output *output);
+
+void presentation_cleanup_output(struct glwall_output *output);
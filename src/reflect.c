@@ -0,0 +1,100 @@
+#include "reflect.h"
+#include "utils.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REFLECT_MAX_NAME_LEN 256
+
+struct reflect_name_need {
+    const char *name;
+    uint32_t needs;
+};
+
+static const struct reflect_name_need uniform_needs[] = {
+    {"iTime", GLWALL_NEED_TIME},      {"time", GLWALL_NEED_TIME},
+    {"Time", GLWALL_NEED_TIME},       {"iTimeDelta", GLWALL_NEED_TIME},
+    {"FrameTime", GLWALL_NEED_TIME},  {"iFrame", GLWALL_NEED_FRAME},
+    {"FrameCount", GLWALL_NEED_FRAME}, {"iMouse", GLWALL_NEED_MOUSE},
+    {"mouse", GLWALL_NEED_MOUSE},     {"sound", GLWALL_NEED_AUDIO},
+    {"soundRes", GLWALL_NEED_AUDIO},  {NULL, 0},
+};
+
+static const struct reflect_name_need state_block_member_needs[] = {
+    {"iTime_frame", GLWALL_NEED_TIME | GLWALL_NEED_FRAME},
+    {"iMouse", GLWALL_NEED_MOUSE},
+    {NULL, 0},
+};
+
+static uint32_t lookup_needs(const struct reflect_name_need *table, const char *name, size_t len) {
+    for (int i = 0; table[i].name; i++) {
+        if (strlen(table[i].name) == len && strncmp(table[i].name, name, len) == 0)
+            return table[i].needs;
+    }
+    return 0;
+}
+
+uint32_t reflect_program_needs(GLuint program) {
+    if (!program)
+        return 0;
+
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+    uint32_t needs = 0;
+    for (GLint i = 0; i < count; i++) {
+        GLuint index = (GLuint)i;
+        GLint block_index = -1;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block_index);
+        if (block_index != -1)
+            continue;
+
+        char name[REFLECT_MAX_NAME_LEN];
+        GLsizei len = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, index, sizeof(name), &len, &size, &type, name);
+        const char *bracket = strchr(name, '[');
+        size_t base_len = bracket ? (size_t)(bracket - name) : (size_t)len;
+        needs |= lookup_needs(uniform_needs, name, base_len);
+    }
+    return needs;
+}
+
+uint32_t reflect_source_needs(const char *source) {
+    if (!source)
+        return 0;
+
+    uint32_t needs = 0;
+    const char *p = source;
+    while (*p) {
+        if (p[0] == '/' && p[1] == '/') {
+            const char *eol = strchr(p, '\n');
+            if (!eol)
+                break;
+            p = eol + 1;
+        } else if (p[0] == '/' && p[1] == '*') {
+            const char *end = strstr(p + 2, "*/");
+            if (!end)
+                break;
+            p = end + 2;
+        } else if (isalpha((unsigned char)*p) || *p == '_') {
+            const char *start = p;
+            while (isalnum((unsigned char)*p) || *p == '_')
+                p++;
+            needs |= lookup_needs(state_block_member_needs, start, (size_t)(p - start));
+        } else if (isdigit((unsigned char)*p)) {
+            while (isalnum((unsigned char)*p) || *p == '.')
+                p++;
+        } else {
+            p++;
+        }
+    }
+    return needs;
+}
+
+bool reflect_needs_animation(uint32_t needs) {
+    return (needs & (GLWALL_NEED_TIME | GLWALL_NEED_FRAME | GLWALL_NEED_MOUSE |
+                     GLWALL_NEED_AUDIO)) != 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "state.h"
+
+uint32_t reflect_program_needs(GLuint program);
+
+uint32_t reflect_source_needs(const char *source);
+
+bool reflect_needs_animation(uint32_t needs);
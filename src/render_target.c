@@ -0,0 +1,120 @@
+#include "render_target.h"
+#include "gl_alloc.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+bool render_target_ensure(struct glwall_render_target *target, struct glwall_gpu_mem *mem,
+                          uint32_t owner, int32_t width_px, int32_t height_px) {
+    assert(target != NULL);
+    assert(width_px > 0 && height_px > 0);
+
+    if (target->fbo && target->width_px == width_px && target->height_px == height_px)
+        return true;
+
+    if (!target->tex)
+        glGenTextures(1, &target->tex);
+    glBindTexture(GL_TEXTURE_2D, target->tex);
+    gl_alloc_tex_image_2d(mem, GLWALL_GPU_MEM_RENDER_TARGET, owner, target->tex, GL_RGBA8, width_px,
+                          height_px, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!target->fbo)
+        glGenFramebuffers(1, &target->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->tex, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        render_target_destroy(target, mem);
+        return false;
+    }
+    target->width_px = width_px;
+    target->height_px = height_px;
+    return true;
+}
+
+void render_target_destroy(struct glwall_render_target *target, struct glwall_gpu_mem *mem) {
+    assert(target != NULL);
+
+    if (target->fbo)
+        glDeleteFramebuffers(1, &target->fbo);
+    if (target->tex)
+        gl_alloc_delete_textures(mem, 1, &target->tex);
+    target->fbo = 0;
+    target->tex = 0;
+    target->width_px = 0;
+    target->height_px = 0;
+}
+
+bool gpu_timer_init(struct glwall_gpu_timer *timer) {
+    assert(timer != NULL);
+
+    glGenQueries(GLWALL_GPU_TIMER_SLOTS * 2, &timer->queries[0][0]);
+    for (int i = 0; i < GLWALL_GPU_TIMER_SLOTS; i++)
+        timer->pending[i] = false;
+    timer->head = 0;
+    timer->tail = 0;
+    timer->active = false;
+    return timer->queries[0][0] != 0;
+}
+
+void gpu_timer_begin(struct glwall_gpu_timer *timer) {
+    assert(timer != NULL);
+
+    timer->active = timer->queries[0][0] != 0 && !timer->pending[timer->head];
+    if (timer->active)
+        glQueryCounter(timer->queries[timer->head][0], GL_TIMESTAMP);
+}
+
+void gpu_timer_end(struct glwall_gpu_timer *timer) {
+    assert(timer != NULL);
+
+    if (!timer->active)
+        return;
+    glQueryCounter(timer->queries[timer->head][1], GL_TIMESTAMP);
+    timer->pending[timer->head] = true;
+    timer->head = (timer->head + 1) % GLWALL_GPU_TIMER_SLOTS;
+    timer->active = false;
+}
+
+bool gpu_timer_poll(struct glwall_gpu_timer *timer, double *gpu_ms) {
+    assert(timer != NULL);
+    assert(gpu_ms != NULL);
+
+    bool have_result = false;
+    while (timer->pending[timer->tail]) {
+        GLint available = 0;
+        glGetQueryObjectiv(timer->queries[timer->tail][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(timer->queries[timer->tail][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(timer->queries[timer->tail][1], GL_QUERY_RESULT, &end);
+        *gpu_ms = end > start ? (double)(end - start) / 1e6 : 0.0;
+        have_result = true;
+
+        timer->pending[timer->tail] = false;
+        timer->tail = (timer->tail + 1) % GLWALL_GPU_TIMER_SLOTS;
+    }
+    return have_result;
+}
+
+void gpu_timer_destroy(struct glwall_gpu_timer *timer) {
+    assert(timer != NULL);
+
+    if (timer->queries[0][0])
+        glDeleteQueries(GLWALL_GPU_TIMER_SLOTS * 2, &timer->queries[0][0]);
+    for (int i = 0; i < GLWALL_GPU_TIMER_SLOTS; i++) {
+        timer->queries[i][0] = 0;
+        timer->queries[i][1] = 0;
+        timer->pending[i] = false;
+    }
+    timer->active = false;
+}
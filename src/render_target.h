@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <GL/glew.h>
+
+#include "gpu_mem.h"
+
+#define GLWALL_GPU_TIMER_SLOTS 4
+
+struct glwall_render_target {
+    GLuint fbo;
+    GLuint tex;
+    int32_t width_px;
+    int32_t height_px;
+};
+
+struct glwall_gpu_timer {
+    GLuint queries[GLWALL_GPU_TIMER_SLOTS][2];
+    bool pending[GLWALL_GPU_TIMER_SLOTS];
+    int head;
+    int tail;
+    bool active;
+};
+
+bool render_target_ensure(struct glwall_render_target *target, struct glwall_gpu_mem *mem,
+                          uint32_t owner, int32_t width_px, int32_t height_px);
+
+void render_target_destroy(struct glwall_render_target *target, struct glwall_gpu_mem *mem);
+
+bool gpu_timer_init(struct glwall_gpu_timer *timer);
+
+void gpu_timer_begin(struct glwall_gpu_timer *timer);
+
+void gpu_timer_end(struct glwall_gpu_timer *timer);
+
+bool gpu_timer_poll(struct glwall_gpu_timer *timer, double *gpu_ms);
+
+void gpu_timer_destroy(struct glwall_gpu_timer *timer);
@@ -0,0 +1,500 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "render_thread.h"
+#include "audio.h"
+#include "capture.h"
+#include "egl.h"
+#include "gl_alloc.h"
+#include "opengl.h"
+#include "presentation.h"
+#include "scheduler.h"
+#include "seqlock.h"
+#include "snapshot.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#define GLWALL_DEFAULT_REFRESH_MHZ 60000
+#define GLWALL_PUBLISH_TICKS_PER_FRAME 4
+#define GLWALL_PUBLISH_IDLE_NS 1000000000ULL
+
+struct glwall_frame_inputs {
+    float time_sec;
+    struct glwall_pointer_snapshot pointer;
+    bool has_audio;
+    float audio[GLWALL_AUDIO_TEXELS];
+};
+
+struct glwall_render_thread {
+    struct glwall_output *output;
+    EGLContext context;
+    pthread_t thread;
+
+    struct wl_event_queue *queue;
+    struct wl_surface *surface;
+    struct wp_presentation *presentation;
+    struct wl_callback *frame_callback;
+    bool frame_ready;
+    int wake_fd;
+    int timer_fd;
+
+    struct glwall_frame_inputs inputs;
+
+    pthread_mutex_t lock;
+    int32_t width_px;
+    int32_t height_px;
+    int32_t logical_width;
+    int32_t logical_height;
+    int32_t refresh_mhz;
+    bool resize_pending;
+    bool redraw_pending;
+    bool quit;
+};
+
+struct glwall_render_publisher {
+    struct glwall_seqlock inputs;
+    struct glwall_frame_inputs buffer;
+    int timer_fd;
+    _Atomic uint64_t last_demand_ns;
+    _Atomic uint64_t interval_ns;
+};
+
+static void frame_done(void *data, struct wl_callback *callback, uint32_t time) {
+    (void)time;
+    struct glwall_render_thread *rt = data;
+    wl_callback_destroy(callback);
+    rt->frame_callback = NULL;
+    rt->frame_ready = true;
+}
+
+static const struct wl_callback_listener thread_frame_listener = {
+    .done = frame_done,
+};
+
+static void request_frame(struct glwall_render_thread *rt) {
+    if (rt->frame_callback)
+        wl_callback_destroy(rt->frame_callback);
+    rt->frame_callback = wl_surface_frame(rt->surface);
+    wl_callback_add_listener(rt->frame_callback, &thread_frame_listener, rt);
+    wl_surface_commit(rt->surface);
+    rt->frame_ready = false;
+}
+
+static void drain_fd(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == sizeof(value))
+        ;
+}
+
+static void arm_publish_timer(struct glwall_render_publisher *publisher, uint64_t interval_ns) {
+    struct itimerspec spec = {0};
+    spec.it_interval.tv_sec = (time_t)(interval_ns / 1000000000ULL);
+    spec.it_interval.tv_nsec = (long)(interval_ns % 1000000000ULL);
+    spec.it_value.tv_nsec = interval_ns > 0 ? 1 : 0;
+    timerfd_settime(publisher->timer_fd, 0, &spec, NULL);
+}
+
+static void update_publish_interval(struct glwall_state *state) {
+    int32_t fastest_mhz = GLWALL_DEFAULT_REFRESH_MHZ;
+    for (const struct glwall_output *output = state->outputs; output; output = output->next) {
+        if (output->refresh_mhz > fastest_mhz)
+            fastest_mhz = output->refresh_mhz;
+    }
+    struct glwall_render_publisher *publisher = state->render_publisher;
+    uint64_t interval_ns =
+        1000000000000ULL / (uint64_t)fastest_mhz / GLWALL_PUBLISH_TICKS_PER_FRAME;
+    if (atomic_exchange(&publisher->interval_ns, interval_ns) != interval_ns &&
+        monotonic_time_ns() - atomic_load(&publisher->last_demand_ns) <= GLWALL_PUBLISH_IDLE_NS)
+        arm_publish_timer(publisher, interval_ns);
+}
+
+static void claim_demand(struct glwall_render_publisher *publisher) {
+    uint64_t now_ns = monotonic_time_ns();
+    uint64_t last_ns = atomic_exchange(&publisher->last_demand_ns, now_ns);
+    if (now_ns - last_ns > GLWALL_PUBLISH_IDLE_NS)
+        arm_publish_timer(publisher, atomic_load(&publisher->interval_ns));
+}
+
+static bool wait_for_events(struct glwall_render_thread *rt) {
+    struct wl_display *display = rt->output->state->display;
+    while (wl_display_prepare_read_queue(display, rt->queue) != 0) {
+        if (wl_display_dispatch_queue_pending(display, rt->queue) < 0)
+            return false;
+    }
+    wl_display_flush(display);
+
+    struct pollfd fds[3] = {
+        {.fd = wl_display_get_fd(display), .events = POLLIN},
+        {.fd = rt->wake_fd, .events = POLLIN},
+        {.fd = rt->timer_fd, .events = POLLIN},
+    };
+    if (poll(fds, 3, -1) < 0) {
+        wl_display_cancel_read(display);
+        return errno == EINTR;
+    }
+    if (fds[0].revents & POLLIN) {
+        if (wl_display_read_events(display) < 0)
+            return false;
+    } else {
+        wl_display_cancel_read(display);
+    }
+    if (wl_display_dispatch_queue_pending(display, rt->queue) < 0)
+        return false;
+    if (fds[1].revents & POLLIN)
+        drain_fd(rt->wake_fd);
+    if (fds[2].revents & POLLIN) {
+        drain_fd(rt->timer_fd);
+        request_frame(rt);
+    }
+    return true;
+}
+
+static bool wait_for_frame(struct glwall_render_thread *rt, struct glwall_frame_params *params,
+                           int32_t *refresh_mhz, bool *resize) {
+    struct glwall_state *state = rt->output->state;
+    for (;;) {
+        pthread_mutex_lock(&rt->lock);
+        bool quit = rt->quit;
+        bool ready = rt->width_px > 0 &&
+                     (state->render_once ? rt->redraw_pending
+                                         : rt->frame_ready || rt->resize_pending);
+        if (!quit && ready) {
+            params->width_px = rt->width_px;
+            params->height_px = rt->height_px;
+            params->logical_width = rt->logical_width;
+            params->logical_height = rt->logical_height;
+            *refresh_mhz = rt->refresh_mhz > 0 ? rt->refresh_mhz : GLWALL_DEFAULT_REFRESH_MHZ;
+            *resize = rt->resize_pending;
+            rt->resize_pending = false;
+            rt->redraw_pending = false;
+        }
+        pthread_mutex_unlock(&rt->lock);
+        if (quit)
+            return false;
+        if (ready)
+            return true;
+        if (!wait_for_events(rt))
+            return false;
+    }
+}
+
+static void schedule_next_frame(struct glwall_render_thread *rt, uint64_t frame_start_ns,
+                                int32_t refresh_mhz, int32_t divisor) {
+    if (divisor > 1) {
+        uint64_t period_ns = 1000000000000ULL / (uint64_t)refresh_mhz;
+        uint64_t deadline_ns =
+            frame_start_ns + (uint64_t)(divisor - 1) * period_ns + period_ns / 4;
+        struct itimerspec spec = {0};
+        spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+        spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+        if (timerfd_settime(rt->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0) {
+            rt->frame_ready = false;
+            return;
+        }
+    }
+    request_frame(rt);
+}
+
+static void *render_thread_main(void *data) {
+    struct glwall_render_thread *rt = data;
+    struct glwall_output *output = rt->output;
+    struct glwall_state *state = output->state;
+
+    if (!eglMakeCurrent(state->egl_display, output->egl_surface, output->egl_surface,
+                        rt->context)) {
+        LOG_ERROR("Render thread: unable to bind context for output %u (EGL error: 0x%x)",
+                  output->output_name, eglGetError());
+        return NULL;
+    }
+    eglSwapInterval(state->egl_display, 0);
+
+    struct glwall_user_program program = {0};
+    if (!user_program_link_copy(state, &program)) {
+        LOG_ERROR("Render thread: unable to link the shader for output %u", output->output_name);
+        eglMakeCurrent(state->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        return NULL;
+    }
+    GLuint audio_texture = 0;
+    if (state->audio_enabled && state->audio.backend_ready)
+        audio_texture = audio_create_texture(state, output->output_name);
+
+    GLuint vao = 0, ubo = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    gl_alloc_buffer_data(&state->gpu_mem, GLWALL_GPU_MEM_UBO, output->output_name,
+                         GL_UNIFORM_BUFFER, ubo, 12 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo);
+    glEnable(GL_BLEND);
+
+    float last_time_sec = 0.0f;
+    unsigned audio_seq = 0;
+    int frame = 0;
+    int32_t target_fps = scheduler_target_fps(state);
+    struct glwall_frame_params params = {0};
+    int32_t refresh_mhz;
+    bool resize;
+
+    while (wait_for_frame(rt, &params, &refresh_mhz, &resize)) {
+        if (resize)
+            wl_egl_window_resize(output->wl_egl_window, params.width_px, params.height_px, 0, 0);
+
+        uint64_t frame_start_ns = monotonic_time_ns();
+        if (!state->render_once)
+            claim_demand(state->render_publisher);
+        unsigned seq = seqlock_read(&state->render_publisher->inputs, &rt->inputs);
+        if (audio_texture && rt->inputs.has_audio && seq != audio_seq) {
+            audio_upload_texels(audio_texture, rt->inputs.audio);
+            audio_seq = seq;
+        }
+
+        params.time_sec = rt->inputs.time_sec;
+        params.time_delta = frame == 0 ? 0.0f : params.time_sec - last_time_sec;
+        params.frame = ++frame;
+        params.ubo = ubo;
+        params.program = &program;
+        params.audio_texture = audio_texture;
+        params.pointer = rt->inputs.pointer;
+        last_time_sec = params.time_sec;
+        int32_t divisor = scheduler_frame_divisor(refresh_mhz, target_fps);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, params.width_px, params.height_px);
+        render_single_shader(output, &params);
+        snapshot_capture_if_due(output);
+        capture_frame(output);
+        presentation_request_feedback_on(output, rt->presentation, frame_start_ns, divisor);
+        eglSwapBuffers(state->egl_display, output->egl_surface);
+
+        if (!state->render_once)
+            schedule_next_frame(rt, frame_start_ns, refresh_mhz, divisor);
+    }
+
+    presentation_discard_pending(output);
+
+    if (rt->frame_callback) {
+        wl_callback_destroy(rt->frame_callback);
+        rt->frame_callback = NULL;
+    }
+    gl_alloc_delete_buffers(&state->gpu_mem, 1, &ubo);
+    glDeleteVertexArrays(1, &vao);
+    if (audio_texture)
+        gl_alloc_delete_textures(&state->gpu_mem, 1, &audio_texture);
+    user_program_destroy(&program);
+    eglMakeCurrent(state->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    return NULL;
+}
+
+static void destroy_render_thread(struct glwall_state *state, struct glwall_render_thread *rt) {
+    if (rt->context != EGL_NO_CONTEXT)
+        eglDestroyContext(state->egl_display, rt->context);
+    if (rt->surface)
+        wl_proxy_wrapper_destroy(rt->surface);
+    if (rt->presentation)
+        wl_proxy_wrapper_destroy(rt->presentation);
+    if (rt->queue)
+        wl_event_queue_destroy(rt->queue);
+    if (rt->wake_fd >= 0)
+        close(rt->wake_fd);
+    if (rt->timer_fd >= 0)
+        close(rt->timer_fd);
+    pthread_mutex_destroy(&rt->lock);
+    free(rt);
+}
+
+static struct glwall_render_thread *create_render_thread(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    struct glwall_render_thread *rt = calloc(1, sizeof(*rt));
+    if (!rt) {
+        LOG_ERROR("%s", "Memory allocation failed: unable to allocate render thread");
+        return NULL;
+    }
+    rt->output = output;
+    rt->frame_ready = true;
+    rt->context = EGL_NO_CONTEXT;
+    pthread_mutex_init(&rt->lock, NULL);
+    rt->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    rt->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    rt->queue = wl_display_create_queue(state->display);
+    rt->surface = rt->queue ? wl_proxy_create_wrapper(output->wl_surface) : NULL;
+    if (rt->wake_fd < 0 || rt->timer_fd < 0 || !rt->surface) {
+        LOG_ERROR("Render thread: unable to set up event sources for output %u",
+                  output->output_name);
+        destroy_render_thread(state, rt);
+        return NULL;
+    }
+    wl_proxy_set_queue((struct wl_proxy *)rt->surface, rt->queue);
+    if (state->presentation) {
+        rt->presentation = wl_proxy_create_wrapper(state->presentation);
+        if (!rt->presentation) {
+            LOG_ERROR("Render thread: unable to set up frame timing for output %u",
+                      output->output_name);
+            destroy_render_thread(state, rt);
+            return NULL;
+        }
+        wl_proxy_set_queue((struct wl_proxy *)rt->presentation, rt->queue);
+    }
+
+    rt->context = egl_create_shared_context(state);
+    if (rt->context == EGL_NO_CONTEXT) {
+        destroy_render_thread(state, rt);
+        return NULL;
+    }
+    return rt;
+}
+
+static void wake_thread(struct glwall_render_thread *rt) {
+    uint64_t one = 1;
+    if (write(rt->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        LOG_WARN("Render thread: unable to wake output %u (errno: %s)", rt->output->output_name,
+                 strerror(errno));
+}
+
+bool render_threads_start(struct glwall_state *state) {
+    assert(state != NULL);
+
+    struct glwall_render_publisher *publisher = calloc(1, sizeof(*publisher));
+    if (!publisher ||
+        !seqlock_init(&publisher->inputs, sizeof(struct glwall_frame_inputs))) {
+        LOG_ERROR("%s", "Memory allocation failed: unable to allocate render thread inputs");
+        free(publisher);
+        goto fail;
+    }
+    state->render_publisher = publisher;
+    publisher->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (publisher->timer_fd < 0) {
+        LOG_ERROR("Render threads: timerfd unavailable (errno: %s)", strerror(errno));
+        goto fail;
+    }
+    atomic_store(&publisher->last_demand_ns, 0);
+    update_publish_interval(state);
+
+    eglMakeCurrent(state->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    render_threads_publish(state);
+
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        struct glwall_render_thread *rt = create_render_thread(output);
+        if (!rt)
+            goto fail;
+        output->render_thread = rt;
+        if (output->configured)
+            render_thread_update(output);
+        int err = pthread_create(&rt->thread, NULL, render_thread_main, rt);
+        if (err != 0) {
+            LOG_ERROR("Render thread: unable to start thread for output %u (errno: %s)",
+                      output->output_name, strerror(err));
+            output->render_thread = NULL;
+            destroy_render_thread(state, rt);
+            goto fail;
+        }
+        LOG_DEBUG(state, "Render thread: started for output %u", output->output_name);
+    }
+    LOG_INFO("%s", "Render threads: one render thread per output");
+    return true;
+
+fail:
+    LOG_WARN("%s", "Render threads unavailable; rendering on the main thread");
+    render_threads_stop(state);
+    state->render_threads = false;
+    return false;
+}
+
+void render_threads_stop(struct glwall_state *state) {
+    bool stopped = false;
+    for (struct glwall_output *output = state->outputs; output; output = output->next) {
+        struct glwall_render_thread *rt = output->render_thread;
+        if (!rt)
+            continue;
+        pthread_mutex_lock(&rt->lock);
+        rt->quit = true;
+        pthread_mutex_unlock(&rt->lock);
+        wake_thread(rt);
+        pthread_join(rt->thread, NULL);
+        destroy_render_thread(state, rt);
+        output->render_thread = NULL;
+        stopped = true;
+    }
+    if (stopped) {
+        struct glwall_output *first = state->outputs;
+        eglMakeCurrent(state->egl_display, first->egl_surface, first->egl_surface,
+                       state->egl_context);
+    }
+    struct glwall_render_publisher *publisher = state->render_publisher;
+    if (!publisher)
+        return;
+    if (publisher->timer_fd >= 0)
+        close(publisher->timer_fd);
+    seqlock_destroy(&publisher->inputs);
+    free(publisher);
+    state->render_publisher = NULL;
+}
+
+void render_thread_update(struct glwall_output *output) {
+    struct glwall_render_thread *rt = output->render_thread;
+    pthread_mutex_lock(&rt->lock);
+    if (rt->width_px != output->width_px || rt->height_px != output->height_px) {
+        rt->width_px = output->width_px;
+        rt->height_px = output->height_px;
+        rt->resize_pending = true;
+        rt->redraw_pending = true;
+    }
+    rt->logical_width = output->logical_width;
+    rt->logical_height = output->logical_height;
+    rt->refresh_mhz = output->refresh_mhz;
+    pthread_mutex_unlock(&rt->lock);
+    update_publish_interval(output->state);
+    wake_thread(rt);
+}
+
+void render_thread_request_redraw(struct glwall_output *output) {
+    struct glwall_render_thread *rt = output->render_thread;
+    pthread_mutex_lock(&rt->lock);
+    rt->redraw_pending = true;
+    pthread_mutex_unlock(&rt->lock);
+    wake_thread(rt);
+}
+
+int render_threads_publish_fd(const struct glwall_state *state) {
+    return state->render_publisher ? state->render_publisher->timer_fd : -1;
+}
+
+void render_threads_publish(struct glwall_state *state) {
+    struct glwall_render_publisher *publisher = state->render_publisher;
+    if (!publisher)
+        return;
+    if (publisher->timer_fd >= 0)
+        drain_fd(publisher->timer_fd);
+    dump_timing_if_requested(state);
+
+    struct glwall_frame_inputs *inputs = &publisher->buffer;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    inputs->time_sec = (float)(now.tv_sec - state->start_time.tv_sec) +
+                       (float)(now.tv_nsec - state->start_time.tv_nsec) / 1e9f;
+    inputs->pointer.output = state->pointer_output;
+    inputs->pointer.global = state->input_impl != NULL || state->pointer_global;
+    inputs->pointer.x = state->pointer_x;
+    inputs->pointer.y = state->pointer_y;
+    inputs->pointer.down_x = state->pointer_down_x;
+    inputs->pointer.down_y = state->pointer_down_y;
+    inputs->pointer.down = state->pointer_down;
+    inputs->has_audio = audio_compute_texels(state, inputs->audio);
+    seqlock_write(&publisher->inputs, inputs);
+
+    if (monotonic_time_ns() - atomic_load(&publisher->last_demand_ns) > GLWALL_PUBLISH_IDLE_NS) {
+        arm_publish_timer(publisher, 0);
+        if (monotonic_time_ns() - atomic_load(&publisher->last_demand_ns) <=
+            GLWALL_PUBLISH_IDLE_NS)
+            arm_publish_timer(publisher, atomic_load(&publisher->interval_ns));
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "state.h"
+
+bool render_threads_start(struct glwall_state *state);
+
+void render_threads_stop(struct glwall_state *state);
+
+void render_thread_update(struct glwall_output *output);
+
+void render_thread_request_redraw(struct glwall_output *output);
+
+int render_threads_publish_fd(const struct glwall_state *state);
+
+void render_threads_publish(struct glwall_state *state);
@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "replay.h"
+#include "trace.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct glwall_replay {
+    struct glwall_trace trace;
+    bool replaying;
+    struct glwall_trace_frame current;
+    struct glwall_trace_frame next;
+    bool has_next;
+    bool frame_open;
+    bool finished;
+    uint64_t frames;
+};
+
+static int32_t output_index(const struct glwall_state *state, const struct glwall_output *output) {
+    int32_t index = 0;
+    for (const struct glwall_output *o = state->outputs; o; o = o->next, index++) {
+        if (o == output)
+            return index;
+    }
+    return -1;
+}
+
+static struct glwall_output *output_at(const struct glwall_state *state, int32_t index) {
+    struct glwall_output *o = state->outputs;
+    for (int32_t i = 0; o && i < index; i++)
+        o = o->next;
+    return index >= 0 ? o : NULL;
+}
+
+bool replay_init(struct glwall_state *state) {
+    assert(state != NULL);
+
+    if (!state->record_path && !state->replay_path)
+        return true;
+    if (state->record_path && state->replay_path) {
+        LOG_ERROR("%s", "Configuration error: --record and --replay are mutually exclusive");
+        return false;
+    }
+    if (state->render_threads) {
+        LOG_WARN("%s", "--render-threads is ignored while recording or replaying");
+        state->render_threads = false;
+    }
+
+    struct glwall_replay *replay = calloc(1, sizeof(*replay));
+    if (!replay) {
+        LOG_ERROR("%s", "Memory allocation failed: insufficient memory for replay state");
+        return false;
+    }
+
+    if (state->record_path) {
+        if (!trace_open_write(&replay->trace, state->record_path)) {
+            LOG_ERROR("File operation failed: unable to create recording '%s'",
+                      state->record_path);
+            free(replay);
+            return false;
+        }
+        LOG_INFO("Recording time, input and audio to %s", state->record_path);
+    } else {
+        if (!trace_open_read(&replay->trace, state->replay_path)) {
+            LOG_ERROR("File operation failed: '%s' is not a glwall recording", state->replay_path);
+            free(replay);
+            return false;
+        }
+        replay->replaying = true;
+        replay->has_next = trace_read_frame(&replay->trace, &replay->next);
+        if (replay->has_next && replay->next.has_audio) {
+            state->audio_enabled = true;
+            state->audio_source = GLWALL_AUDIO_SOURCE_REPLAY;
+        }
+        LOG_INFO("Replaying recording %s", state->replay_path);
+    }
+    state->replay = replay;
+    return true;
+}
+
+void replay_begin_frame(struct glwall_state *state, float *time_sec, float *dt_sec, int *frame) {
+    struct glwall_replay *replay = state->replay;
+    if (!replay)
+        return;
+
+    if (!replay->replaying) {
+        struct glwall_trace_frame *f = &replay->current;
+        f->time_sec = *time_sec;
+        f->dt_sec = *dt_sec;
+        f->frame = *frame;
+        f->pointer_output = output_index(state, state->pointer_output);
+        f->pointer_x = state->pointer_x;
+        f->pointer_y = state->pointer_y;
+        f->pointer_down_x = state->pointer_down_x;
+        f->pointer_down_y = state->pointer_down_y;
+        f->pointer_down = state->pointer_down;
+        f->pointer_global = state->input_impl != NULL;
+        f->has_audio = false;
+        replay->frame_open = true;
+        return;
+    }
+
+    if (replay->has_next) {
+        replay->current = replay->next;
+        replay->frames++;
+        replay->has_next = trace_read_frame(&replay->trace, &replay->next);
+        if (!replay->has_next && replay->trace.error)
+            LOG_WARN("%s", "Replay: recording is truncated; stopping at the last complete frame");
+    } else if (!replay->finished) {
+        LOG_INFO("Replay finished after %llu frame(s)", (unsigned long long)replay->frames);
+        replay->finished = true;
+        state->running = false;
+    }
+
+    if (replay->frames == 0)
+        return;
+    const struct glwall_trace_frame *f = &replay->current;
+    *time_sec = f->time_sec;
+    *dt_sec = f->dt_sec;
+    *frame = f->frame;
+    state->pointer_output = output_at(state, f->pointer_output);
+    state->pointer_x = f->pointer_x;
+    state->pointer_y = f->pointer_y;
+    state->pointer_down_x = f->pointer_down_x;
+    state->pointer_down_y = f->pointer_down_y;
+    state->pointer_down = f->pointer_down;
+    state->pointer_global = f->pointer_global;
+}
+
+bool replay_audio_block(struct glwall_state *state, int16_t *samples) {
+    struct glwall_replay *replay = state->replay;
+    if (!replay || !replay->replaying || !replay->current.has_audio)
+        return false;
+    memcpy(samples, replay->current.audio, sizeof(replay->current.audio));
+    return true;
+}
+
+void record_audio_block(struct glwall_state *state, const int16_t *samples) {
+    struct glwall_replay *replay = state->replay;
+    if (!replay || replay->replaying || !replay->frame_open)
+        return;
+    memcpy(replay->current.audio, samples, sizeof(replay->current.audio));
+    replay->current.has_audio = true;
+}
+
+void replay_end_frame(struct glwall_state *state) {
+    struct glwall_replay *replay = state->replay;
+    if (!replay || replay->replaying || !replay->frame_open)
+        return;
+
+    replay->frame_open = false;
+    if (replay->trace.error)
+        return;
+    if (!trace_write_frame(&replay->trace, &replay->current)) {
+        LOG_ERROR("File operation failed: unable to write to recording '%s'; recording stopped",
+                  state->record_path);
+        return;
+    }
+    replay->frames++;
+}
+
+void replay_cleanup(struct glwall_state *state) {
+    struct glwall_replay *replay = state->replay;
+    if (!replay)
+        return;
+
+    bool ok = trace_close(&replay->trace);
+    if (!replay->replaying) {
+        if (ok) {
+            LOG_INFO("Recorded %llu frame(s) to %s", (unsigned long long)replay->frames,
+                     state->record_path);
+        } else {
+            LOG_ERROR("File operation failed: recording '%s' is incomplete", state->record_path);
+        }
+    }
+    free(replay);
+    state->replay = NULL;
+}
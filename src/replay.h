@@ -0,0 +1,15 @@
+#pragma once
+
+#include "state.h"
+
+bool replay_init(struct glwall_state *state);
+
+void replay_begin_frame(struct glwall_state *state, float *time_sec, float *dt_sec, int *frame);
+
+bool replay_audio_block(struct glwall_state *state, int16_t *samples);
+
+void record_audio_block(struct glwall_state *state, const int16_t *samples);
+
+void replay_end_frame(struct glwall_state *state);
+
+void replay_cleanup(struct glwall_state *state);
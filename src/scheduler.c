@@ -0,0 +1,162 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "scheduler.h"
+#include "deep_pause.h"
+#include "opengl.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#define GLWALL_DEFAULT_REFRESH_MHZ 60000
+#define GLWALL_THROTTLED_FPS 30
+#define GLWALL_PAUSED_FPS 1
+#define GLWALL_DIVISOR_TOLERANCE 0.01
+
+bool scheduler_init_output(struct glwall_output *output) {
+    assert(output != NULL);
+
+    output->frame_divisor = 1;
+    output->frame_scheduled = false;
+    output->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (output->timer_fd < 0) {
+        LOG_WARN("Frame scheduler: timerfd unavailable for output %u (errno: %s); rendering at "
+                 "refresh rate",
+                 output->output_name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void scheduler_cleanup_output(struct glwall_output *output) {
+    if (output->timer_fd >= 0) {
+        close(output->timer_fd);
+        output->timer_fd = -1;
+    }
+}
+
+int32_t scheduler_target_fps(const struct glwall_state *state) {
+    switch (state->power_mode) {
+    case GLWALL_POWER_MODE_THROTTLED:
+        if (state->fps_cap > 0 && state->fps_cap < GLWALL_THROTTLED_FPS)
+            return state->fps_cap;
+        return GLWALL_THROTTLED_FPS;
+    case GLWALL_POWER_MODE_PAUSED:
+    case GLWALL_POWER_MODE_DEEP_PAUSED:
+        return GLWALL_PAUSED_FPS;
+    case GLWALL_POWER_MODE_FULL:
+    default:
+        return state->fps_cap;
+    }
+}
+
+int32_t scheduler_frame_divisor(int32_t refresh_mhz, int32_t target_fps) {
+    if (target_fps <= 0)
+        return 1;
+    if (refresh_mhz <= 0)
+        refresh_mhz = GLWALL_DEFAULT_REFRESH_MHZ;
+
+    double ratio = (double)refresh_mhz / (1000.0 * (double)target_fps);
+    int32_t divisor = (int32_t)ceil(ratio - GLWALL_DIVISOR_TOLERANCE);
+    return divisor < 1 ? 1 : divisor;
+}
+
+void scheduler_request_frame(struct glwall_output *output) {
+    struct wl_callback *cb = wl_surface_frame(output->wl_surface);
+    wl_callback_add_listener(cb, &frame_listener, output);
+    wl_surface_commit(output->wl_surface);
+    output->frame_scheduled = true;
+}
+
+void scheduler_frame_rendered(struct glwall_output *output) {
+    assert(output != NULL);
+
+    struct glwall_state *state = output->state;
+    if (deep_pause_enter_if_pending(output))
+        return;
+    if (state->render_once) {
+        LOG_DEBUG(state, "Frame scheduler: output %u is static until the next configure",
+                  output->output_name);
+        return;
+    }
+    if (output->frame_scheduled) {
+        LOG_DEBUG(state, "Frame scheduler: output %u already has a frame scheduled",
+                  output->output_name);
+        return;
+    }
+
+    int32_t refresh_mhz =
+        output->refresh_mhz > 0 ? output->refresh_mhz : GLWALL_DEFAULT_REFRESH_MHZ;
+    int32_t divisor = scheduler_frame_divisor(refresh_mhz, scheduler_target_fps(state))
+                      << output->contention.level;
+    if (divisor != output->frame_divisor) {
+        LOG_DEBUG(state, "Frame scheduler: output %u renders every %d vblank(s) (%.2f Hz)",
+                  output->output_name, divisor, refresh_mhz / 1000.0 / divisor);
+        output->frame_divisor = divisor;
+    }
+
+    if (divisor <= 1 || output->timer_fd < 0) {
+        scheduler_request_frame(output);
+        return;
+    }
+
+    uint64_t period_ns = 1000000000000ULL / (uint64_t)refresh_mhz;
+    uint64_t deadline_ns =
+        output->frame_start_ns + (uint64_t)(divisor - 1) * period_ns + period_ns / 4;
+
+    struct itimerspec spec = {0};
+    spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    if (timerfd_settime(output->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        LOG_WARN("Frame scheduler: unable to arm timer for output %u (errno: %s)",
+                 output->output_name, strerror(errno));
+        scheduler_request_frame(output);
+        return;
+    }
+    output->frame_scheduled = true;
+}
+
+void scheduler_tile_rendered(struct glwall_output *output) {
+    assert(output != NULL);
+
+    if (output->timer_fd < 0) {
+        scheduler_request_frame(output);
+        return;
+    }
+
+    int32_t refresh_mhz =
+        output->refresh_mhz > 0 ? output->refresh_mhz : GLWALL_DEFAULT_REFRESH_MHZ;
+    uint64_t deadline_ns = output->frame_start_ns + 1000000000000ULL / (uint64_t)refresh_mhz;
+
+    struct itimerspec spec = {0};
+    spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    if (timerfd_settime(output->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        LOG_WARN("Frame scheduler: unable to arm tile timer for output %u (errno: %s)",
+                 output->output_name, strerror(errno));
+        scheduler_request_frame(output);
+        return;
+    }
+    output->tile_timer_armed = true;
+    output->frame_scheduled = true;
+}
+
+void scheduler_handle_timer(struct glwall_output *output) {
+    uint64_t expirations = 0;
+    if (read(output->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return;
+
+    output->frame_scheduled = false;
+    if (!output->configured)
+        return;
+    if (output->tile_timer_armed) {
+        output->tile_timer_armed = false;
+        render_frame(output);
+        return;
+    }
+    scheduler_request_frame(output);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "state.h"
+
+bool scheduler_init_output(struct glwall_output *output);
+
+void scheduler_cleanup_output(struct glwall_output *output);
+
+int32_t scheduler_target_fps(const struct glwall_state *state);
+
+int32_t scheduler_frame_divisor(int32_t refresh_mhz, int32_t target_fps);
+
+void scheduler_request_frame(struct glwall_output *output);
+
+void scheduler_frame_rendered(struct glwall_output *output);
+
+void scheduler_tile_rendered(struct glwall_output *output);
+
+void scheduler_handle_timer(struct glwall_output *output);
@@ -0,0 +1,64 @@
+#include "seqlock.h"
+
+#include <assert.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool seqlock_init(struct glwall_seqlock *lock, size_t size) {
+    assert(lock != NULL);
+
+    size_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    lock->words = calloc(words > 0 ? words : 1, sizeof(*lock->words));
+    if (!lock->words)
+        return false;
+    for (size_t i = 0; i < words; i++)
+        atomic_init(&lock->words[i], 0);
+    atomic_init(&lock->seq, 0);
+    lock->size = size;
+    lock->word_count = words;
+    return true;
+}
+
+void seqlock_write(struct glwall_seqlock *lock, const void *value) {
+    const uint8_t *src = value;
+    unsigned seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t i = 0; i < lock->word_count; i++) {
+        uint32_t word = 0;
+        size_t offset = i * sizeof(word);
+        size_t n = lock->size - offset < sizeof(word) ? lock->size - offset : sizeof(word);
+        memcpy(&word, src + offset, n);
+        atomic_store_explicit(&lock->words[i], word, memory_order_relaxed);
+    }
+    atomic_store_explicit(&lock->seq, seq + 2, memory_order_release);
+}
+
+unsigned seqlock_read(struct glwall_seqlock *lock, void *out) {
+    uint8_t *dst = out;
+    for (;;) {
+        unsigned before = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < lock->word_count; i++) {
+            uint32_t word = atomic_load_explicit(&lock->words[i], memory_order_relaxed);
+            size_t offset = i * sizeof(word);
+            size_t n = lock->size - offset < sizeof(word) ? lock->size - offset : sizeof(word);
+            memcpy(dst + offset, &word, n);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&lock->seq, memory_order_relaxed) == before)
+            return before / 2;
+    }
+}
+
+void seqlock_destroy(struct glwall_seqlock *lock) {
+    free(lock->words);
+    lock->words = NULL;
+    lock->word_count = 0;
+    lock->size = 0;
+}
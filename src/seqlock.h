@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct glwall_seqlock {
+    atomic_uint seq;
+    _Atomic uint32_t *words;
+    size_t size;
+    size_t word_count;
+};
+
+bool seqlock_init(struct glwall_seqlock *lock, size_t size);
+
+void seqlock_write(struct glwall_seqlock *lock, const void *value);
+
+unsigned seqlock_read(struct glwall_seqlock *lock, void *out);
+
+void seqlock_destroy(struct glwall_seqlock *lock);
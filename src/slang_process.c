@@ -134,37 +134,63 @@ static char *get_word(const char **p) {
     return word;
 }
 
-static char *extract_fragment_shader(const char *src) {
-    const char *frag_pragma = strstr(src, "#pragma stage fragment");
-    if (!frag_pragma) {
-        return strdup(src);
+struct stage_rules {
+    const char *pragma;
+    const char *const *dropped_inputs;
+    const char *const *dropped_outputs;
+};
+
+static const char *const fragment_dropped_inputs[] = {"vTexCoord", NULL};
+static const char *const fragment_dropped_outputs[] = {"FragColor", NULL};
+static const char *const vertex_dropped_inputs[] = {"Position", "TexCoord", NULL};
+static const char *const vertex_dropped_outputs[] = {NULL};
+
+static const struct stage_rules fragment_rules = {
+    .pragma = "#pragma stage fragment",
+    .dropped_inputs = fragment_dropped_inputs,
+    .dropped_outputs = fragment_dropped_outputs,
+};
+
+static const struct stage_rules vertex_rules = {
+    .pragma = "#pragma stage vertex",
+    .dropped_inputs = vertex_dropped_inputs,
+    .dropped_outputs = vertex_dropped_outputs,
+};
+
+static bool name_in_list(const char *name, const char *const *list) {
+    for (int i = 0; list[i]; i++) {
+        if (strcmp(name, list[i]) == 0)
+            return true;
     }
+    return false;
+}
+
+static char *extract_stage(const char *src, const char *stage_pragma) {
+    const char *stage_start_pragma = strstr(src, stage_pragma);
+    if (!stage_start_pragma)
+        return NULL;
 
     const char *first_pragma = strstr(src, "#pragma stage");
     size_t shared_len = first_pragma ? (size_t)(first_pragma - src) : 0;
 
-    const char *frag_start = frag_pragma + strlen("#pragma stage fragment");
-    const char *next_pragma = strstr(frag_start, "#pragma stage");
-    size_t frag_len = next_pragma ? (size_t)(next_pragma - frag_start) : strlen(frag_start);
+    const char *stage_start = stage_start_pragma + strlen(stage_pragma);
+    const char *next_pragma = strstr(stage_start, "#pragma stage");
+    size_t stage_len = next_pragma ? (size_t)(next_pragma - stage_start) : strlen(stage_start);
 
-    char *out = malloc(shared_len + frag_len + 1);
+    char *out = malloc(shared_len + stage_len + 1);
     if (!out)
         return NULL;
 
     if (shared_len > 0) {
         memcpy(out, src, shared_len);
     }
-    memcpy(out + shared_len, frag_start, frag_len);
-    out[shared_len + frag_len] = '\0';
+    memcpy(out + shared_len, stage_start, stage_len);
+    out[shared_len + stage_len] = '\0';
 
     return out;
 }
 
-char *slang_process_to_gl330(const char *raw_src) {
-    char *src = extract_fragment_shader(raw_src);
-    if (!src)
-        return NULL;
-
+static char *translate_stage(char *src, const struct stage_rules *rules) {
     struct replacement_list list = {0};
     const char *p = src;
 
@@ -341,7 +367,7 @@ char *slang_process_to_gl330(const char *raw_src) {
                 memcpy(name, name_start, name_len);
                 name[name_len] = '\0';
 
-                if (strcmp(name, "vTexCoord") == 0) {
+                if (name_in_list(name, rules->dropped_inputs)) {
                     add_replacement(&list, layout_start - src, (stmt_end - layout_start) + 1, "");
                 } else {
                     add_replacement(&list, layout_start - src, (p - layout_start), "");
@@ -364,7 +390,7 @@ char *slang_process_to_gl330(const char *raw_src) {
                 memcpy(name, name_start, name_len);
                 name[name_len] = '\0';
 
-                if (strcmp(name, "FragColor") == 0) {
+                if (name_in_list(name, rules->dropped_outputs)) {
                     add_replacement(&list, layout_start - src, (stmt_end - layout_start) + 1, "");
                 } else {
                     add_replacement(&list, layout_start - src, (p - layout_start), "");
@@ -384,3 +410,21 @@ char *slang_process_to_gl330(const char *raw_src) {
 
     return result;
 }
+
+char *slang_process_to_gl330(const char *raw_src) {
+    char *src = NULL;
+    if (strstr(raw_src, fragment_rules.pragma))
+        src = extract_stage(raw_src, fragment_rules.pragma);
+    else
+        src = strdup(raw_src);
+    if (!src)
+        return NULL;
+    return translate_stage(src, &fragment_rules);
+}
+
+char *slang_process_vertex_to_gl330(const char *raw_src) {
+    char *src = extract_stage(raw_src, vertex_rules.pragma);
+    if (!src)
+        return NULL;
+    return translate_stage(src, &vertex_rules);
+}
@@ -3,4 +3,6 @@
 
 char *slang_process_to_gl330(const char *src);
 
+char *slang_process_vertex_to_gl330(const char *src);
+
 #endif
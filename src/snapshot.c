@@ -0,0 +1,414 @@
+#define _GNU_SOURCE
+
+#include "snapshot.h"
+#include "gl_alloc.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC "GLWSNAP1"
+#define SNAPSHOT_HEADER_SIZE 16
+#define SNAPSHOT_MAX_SIZE 960
+#define SNAPSHOT_FIRST_DELAY_NS (5ULL * 1000000000ULL)
+#define SNAPSHOT_INTERVAL_NS (60ULL * 1000000000ULL)
+#define SNAPSHOT_STATIC_WAIT_NS 1000000000ULL
+
+struct snapshot_job {
+    struct snapshot_job *next;
+    char path[PATH_MAX];
+    uint32_t *pixels;
+    int32_t width_px;
+    int32_t height_px;
+};
+
+struct glwall_snapshot_writer {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct snapshot_job *head;
+    struct snapshot_job *tail;
+    bool quit;
+};
+
+static uint64_t hash_string(uint64_t hash, const char *s) {
+    for (; s && *s; s++) {
+        hash ^= (uint8_t)*s;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool make_dir(const char *path) {
+    return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+static bool write_snapshot(const char *path, const uint32_t *pixels, int32_t width,
+                           int32_t height) {
+    char tmp[PATH_MAX];
+    int n = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if (n < 0 || (size_t)n >= sizeof(tmp))
+        return false;
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp)
+        return false;
+
+    uint8_t header[SNAPSHOT_HEADER_SIZE];
+    uint32_t w = (uint32_t)width, h = (uint32_t)height;
+    memcpy(header, SNAPSHOT_MAGIC, 8);
+    memcpy(header + 8, &w, sizeof(w));
+    memcpy(header + 12, &h, sizeof(h));
+    bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+    for (int32_t y = height - 1; ok && y >= 0; y--)
+        ok = fwrite(pixels + (size_t)y * w, 4, w, fp) == w;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+static void *snapshot_writer_main(void *data) {
+    struct glwall_snapshot_writer *writer = data;
+
+    pthread_mutex_lock(&writer->lock);
+    for (;;) {
+        while (!writer->head && !writer->quit)
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        struct snapshot_job *job = writer->head;
+        if (!job)
+            break;
+        writer->head = job->next;
+        if (!writer->head)
+            writer->tail = NULL;
+        pthread_mutex_unlock(&writer->lock);
+
+        if (!write_snapshot(job->path, job->pixels, job->width_px, job->height_px))
+            LOG_WARN("File operation failed: unable to write snapshot '%s'", job->path);
+        free(job->pixels);
+        free(job);
+        pthread_mutex_lock(&writer->lock);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+static bool start_writer(struct glwall_state *state) {
+    struct glwall_snapshot_writer *writer = calloc(1, sizeof(*writer));
+    if (!writer)
+        return false;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+
+    sigset_t block, previous;
+    sigemptyset(&block);
+    sigaddset(&block, SIGUSR1);
+    sigaddset(&block, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &block, &previous);
+    int err = pthread_create(&writer->thread, NULL, snapshot_writer_main, writer);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        pthread_cond_destroy(&writer->cond);
+        pthread_mutex_destroy(&writer->lock);
+        free(writer);
+        return false;
+    }
+    state->snapshot_writer = writer;
+    return true;
+}
+
+static void enqueue_job(struct glwall_snapshot_writer *writer, struct snapshot_job *job) {
+    pthread_mutex_lock(&writer->lock);
+    if (writer->tail)
+        writer->tail->next = job;
+    else
+        writer->head = job;
+    writer->tail = job;
+    pthread_cond_signal(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+void snapshot_init(struct glwall_state *state) {
+    if (!state->snapshot || state->headless) {
+        state->snapshot = false;
+        return;
+    }
+
+    char dir[PATH_MAX];
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n = -1;
+    if (cache && cache[0] == '/') {
+        n = snprintf(dir, sizeof(dir), "%s/glwall", cache);
+    } else if (home && home[0] != '\0') {
+        n = snprintf(dir, sizeof(dir), "%s/.cache", home);
+        if (n > 0 && (size_t)n < sizeof(dir))
+            make_dir(dir);
+        n = snprintf(dir, sizeof(dir), "%s/.cache/glwall", home);
+    }
+    if (n < 0 || (size_t)n >= sizeof(dir) || !make_dir(dir) ||
+        !(state->snapshot_dir = strdup(dir))) {
+        LOG_WARN("%s", "Startup snapshot: no usable cache directory; disabled");
+        state->snapshot = false;
+        return;
+    }
+    if (!start_writer(state))
+        LOG_WARN("%s", "Startup snapshot: unable to start writer thread; saving disabled");
+    LOG_DEBUG(state, "Startup snapshot: cache directory %s", state->snapshot_dir);
+}
+
+static bool snapshot_path(const struct glwall_output *output, char *path, size_t size) {
+    const struct glwall_state *state = output->state;
+    if (!state->snapshot_dir || !output->connector)
+        return false;
+    uint64_t hash = hash_string(14695981039346656037ULL, state->shader_path);
+    hash = hash_string(hash_string(hash, "\n"), state->image_path);
+    int n = snprintf(path, size, "%s/%s-%016llx.snap", state->snapshot_dir, output->connector,
+                     (unsigned long long)hash);
+    return n > 0 && (size_t)n < size;
+}
+
+static bool read_full(int fd, void *buf, size_t size) {
+    uint8_t *p = buf;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void snapshot_buffer_release(void *data, struct wl_buffer *buffer) {
+    struct glwall_output *output = data;
+    wl_buffer_destroy(buffer);
+    output->snapshot_buffer = NULL;
+}
+
+static const struct wl_buffer_listener snapshot_buffer_listener = {
+    .release = snapshot_buffer_release,
+};
+
+void snapshot_present(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!state->snapshot || !state->shm || !output->viewport || output->snapshot_shown)
+        return;
+    output->snapshot_shown = true;
+
+    char path[PATH_MAX];
+    if (!snapshot_path(output, path, sizeof(path)))
+        return;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_DEBUG(state, "Startup snapshot: none cached for output %s", output->connector);
+        return;
+    }
+
+    int mem = -1;
+    uint8_t header[SNAPSHOT_HEADER_SIZE];
+    uint32_t width, height;
+    if (!read_full(fd, header, sizeof(header)) || memcmp(header, SNAPSHOT_MAGIC, 8) != 0)
+        goto done;
+    memcpy(&width, header + 8, sizeof(width));
+    memcpy(&height, header + 12, sizeof(height));
+    if (width == 0 || height == 0 || width > SNAPSHOT_MAX_SIZE || height > SNAPSHOT_MAX_SIZE)
+        goto done;
+
+    size_t size = (size_t)width * height * 4;
+    mem = memfd_create("glwall-snapshot", MFD_CLOEXEC);
+    if (mem < 0 || ftruncate(mem, (off_t)size) != 0)
+        goto done;
+    void *pixels = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem, 0);
+    if (pixels == MAP_FAILED)
+        goto done;
+    bool ok = read_full(fd, pixels, size);
+    munmap(pixels, size);
+    if (!ok)
+        goto done;
+
+    struct wl_shm_pool *pool = wl_shm_create_pool(state->shm, mem, (int32_t)size);
+    output->snapshot_buffer =
+        wl_shm_pool_create_buffer(pool, 0, (int32_t)width, (int32_t)height, (int32_t)width * 4,
+                                  WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+    if (!output->snapshot_buffer)
+        goto done;
+
+    wl_buffer_add_listener(output->snapshot_buffer, &snapshot_buffer_listener, output);
+    wl_surface_attach(output->wl_surface, output->snapshot_buffer, 0, 0);
+    wl_surface_damage_buffer(output->wl_surface, 0, 0, (int32_t)width, (int32_t)height);
+    wl_surface_commit(output->wl_surface);
+    wl_display_flush(state->display);
+    LOG_INFO("Startup snapshot: output %s shows cached frame (%u x %u)", output->connector, width,
+             height);
+
+done:
+    if (mem >= 0)
+        close(mem);
+    close(fd);
+}
+
+static void start_readback(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    int32_t src_w = output->width_px;
+    int32_t src_h = output->height_px;
+    int32_t largest = src_w > src_h ? src_w : src_h;
+    int32_t width = src_w, height = src_h;
+    if (largest > SNAPSHOT_MAX_SIZE) {
+        width = (int32_t)((int64_t)src_w * SNAPSHOT_MAX_SIZE / largest);
+        height = (int32_t)((int64_t)src_h * SNAPSHOT_MAX_SIZE / largest);
+    }
+    if (width <= 0 || height <= 0)
+        return;
+
+    GLuint fbo = 0, rbo = 0;
+    glGenRenderbuffers(1, &rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    gl_alloc_renderbuffer_storage(&state->gpu_mem, GLWALL_GPU_MEM_SNAPSHOT, output->output_name,
+                                  rbo, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, src_w, src_h, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    glGenBuffers(1, &output->snapshot_pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, output->snapshot_pbo);
+    gl_alloc_buffer_data(&state->gpu_mem, GLWALL_GPU_MEM_SNAPSHOT, output->output_name,
+                         GL_PIXEL_PACK_BUFFER, output->snapshot_pbo,
+                         (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    gl_alloc_delete_renderbuffers(&state->gpu_mem, 1, &rbo);
+
+    output->snapshot_width_px = width;
+    output->snapshot_height_px = height;
+    output->snapshot_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static struct snapshot_job *create_job(struct glwall_output *output) {
+    struct snapshot_job *job = calloc(1, sizeof(*job));
+    if (!job)
+        return NULL;
+    size_t size = (size_t)output->snapshot_width_px * (size_t)output->snapshot_height_px * 4;
+    job->pixels = snapshot_path(output, job->path, sizeof(job->path)) ? malloc(size) : NULL;
+    if (!job->pixels) {
+        free(job);
+        return NULL;
+    }
+    job->width_px = output->snapshot_width_px;
+    job->height_px = output->snapshot_height_px;
+    return job;
+}
+
+static void finish_readback(struct glwall_output *output, GLuint64 timeout_ns) {
+    struct glwall_state *state = output->state;
+    GLenum status =
+        glClientWaitSync(output->snapshot_fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return;
+
+    struct snapshot_job *job = NULL;
+    if (status == GL_WAIT_FAILED) {
+        LOG_WARN("Startup snapshot: readback of output %u failed", output->output_name);
+        goto done;
+    }
+    job = create_job(output);
+    if (!job) {
+        LOG_WARN("%s", "Memory allocation failed: snapshot dropped");
+        goto done;
+    }
+    size_t size = (size_t)job->width_px * (size_t)job->height_px * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, output->snapshot_pbo);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size,
+                                          GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(job->pixels, mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        LOG_WARN("Startup snapshot: unable to map readback buffer of output %u",
+                 output->output_name);
+        free(job->pixels);
+        free(job);
+        goto done;
+    }
+    LOG_DEBUG(state, "Startup snapshot: saving %d x %d frame of output %s", job->width_px,
+              job->height_px, output->connector);
+    enqueue_job(state->snapshot_writer, job);
+
+done:
+    snapshot_discard_readback(output);
+}
+
+void snapshot_capture_if_due(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!state->snapshot_writer || !output->connector)
+        return;
+
+    if (output->snapshot_fence)
+        finish_readback(output, 0);
+
+    uint64_t now_ns = monotonic_time_ns();
+    if (output->snapshot_due_ns == 0)
+        output->snapshot_due_ns = now_ns + (state->render_once ? 0 : SNAPSHOT_FIRST_DELAY_NS);
+    if (now_ns < output->snapshot_due_ns || output->snapshot_fence)
+        return;
+    output->snapshot_due_ns = now_ns + SNAPSHOT_INTERVAL_NS;
+
+    start_readback(output);
+    bool deep_pause = state->power_mode == GLWALL_POWER_MODE_DEEP_PAUSED;
+    if ((state->render_once || deep_pause) && output->snapshot_fence)
+        finish_readback(output, SNAPSHOT_STATIC_WAIT_NS);
+}
+
+void snapshot_discard_readback(struct glwall_output *output) {
+    if (output->snapshot_fence) {
+        glDeleteSync(output->snapshot_fence);
+        output->snapshot_fence = NULL;
+    }
+    if (output->snapshot_pbo) {
+        gl_alloc_delete_buffers(&output->state->gpu_mem, 1, &output->snapshot_pbo);
+        output->snapshot_pbo = 0;
+    }
+}
+
+void snapshot_cleanup_output(struct glwall_output *output) {
+    if (output->snapshot_buffer) {
+        wl_buffer_destroy(output->snapshot_buffer);
+        output->snapshot_buffer = NULL;
+    }
+}
+
+void snapshot_cleanup(struct glwall_state *state) {
+    struct glwall_snapshot_writer *writer = state->snapshot_writer;
+    if (writer) {
+        pthread_mutex_lock(&writer->lock);
+        writer->quit = true;
+        pthread_cond_signal(&writer->cond);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+        pthread_cond_destroy(&writer->cond);
+        pthread_mutex_destroy(&writer->lock);
+        free(writer);
+        state->snapshot_writer = NULL;
+    }
+    free(state->snapshot_dir);
+    state->snapshot_dir = NULL;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "state.h"
+
+void snapshot_init(struct glwall_state *state);
+
+void snapshot_present(struct glwall_output *output);
+
+void snapshot_capture_if_due(struct glwall_output *output);
+
+void snapshot_discard_readback(struct glwall_output *output);
+
+void snapshot_cleanup_output(struct glwall_output *output);
+
+void snapshot_cleanup(struct glwall_state *state);
@@ -15,6 +15,14 @@
 
 extern const struct wl_callback_listener frame_listener;
 
+#include "contention.h"
+#include "dynres.h"
+#include "frame_stats.h"
+#include "gpu_mem.h"
+#include "hud_canvas.h"
+#include "particles.h"
+#include "render_target.h"
+#include "vertex_budget.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 
 struct glwall_state;
@@ -22,10 +30,23 @@ struct glwall_state;
 struct glwall_preset;
 struct glwall_pipeline;
 
+struct wp_viewporter;
+struct wp_viewport;
+struct wp_fractional_scale_manager_v1;
+struct wp_fractional_scale_v1;
+struct wp_presentation;
+struct wp_presentation_feedback;
+struct glwall_render_thread;
+struct glwall_render_publisher;
+struct glwall_replay;
+struct glwall_capture;
+struct glwall_snapshot_writer;
+
 enum glwall_power_mode {
     GLWALL_POWER_MODE_FULL,
     GLWALL_POWER_MODE_THROTTLED,
     GLWALL_POWER_MODE_PAUSED,
+    GLWALL_POWER_MODE_DEEP_PAUSED,
 };
 
 enum glwall_mouse_overlay_mode {
@@ -34,10 +55,53 @@ enum glwall_mouse_overlay_mode {
     GLWALL_MOUSE_OVERLAY_FULL,
 };
 
+enum glwall_shader_need {
+    GLWALL_NEED_TIME = 1u << 0,
+    GLWALL_NEED_FRAME = 1u << 1,
+    GLWALL_NEED_MOUSE = 1u << 2,
+    GLWALL_NEED_AUDIO = 1u << 3,
+};
+
+struct glwall_pointer_snapshot {
+    const struct glwall_output *output;
+    double x;
+    double y;
+    double down_x;
+    double down_y;
+    bool down;
+    bool global;
+};
+
+struct glwall_user_program {
+    GLuint program;
+    GLint loc_resolution;
+    GLint loc_resolution_vec2;
+    GLint loc_time;
+    GLint loc_time_delta;
+    GLint loc_frame;
+    GLint loc_mouse;
+    GLint loc_mouse_vec2;
+    GLint loc_sound;
+    GLint loc_sound_res;
+    GLint loc_vertex_count;
+    int32_t resolution_w;
+    int32_t resolution_h;
+};
+
+#define GLWALL_PRESENT_PENDING 4
+
+struct glwall_present_pending {
+    struct wp_presentation_feedback *feedback;
+    struct glwall_output *output;
+    uint64_t render_start_ns;
+    int32_t vblanks;
+};
+
 enum glwall_audio_source {
     GLWALL_AUDIO_SOURCE_NONE,
     GLWALL_AUDIO_SOURCE_PULSEAUDIO,
     GLWALL_AUDIO_SOURCE_FAKE,
+    GLWALL_AUDIO_SOURCE_REPLAY,
 };
 
 struct glwall_audio_state {
@@ -63,10 +127,68 @@ struct glwall_output {
     uint32_t output_name;
     int32_t width_px;
     int32_t height_px;
+    int32_t logical_width;
+    int32_t logical_height;
+    int32_t scale;
+    uint32_t preferred_scale_120;
+    struct wp_viewport *viewport;
+    struct wp_fractional_scale_v1 *fractional_scale;
+    int32_t refresh_mhz;
     bool configured;
-    int32_t last_resolution_w;
-    int32_t last_resolution_h;
-    int loc_resolution_last_updated;
+
+    int timer_fd;
+    int32_t frame_divisor;
+    bool frame_scheduled;
+    bool tile_timer_armed;
+    uint64_t frame_start_ns;
+
+    struct glwall_dynres dynres;
+    struct glwall_render_target dynres_target;
+    struct glwall_gpu_timer gpu_timer;
+    struct glwall_vertex_budget vertex_budget;
+    struct glwall_particles particles;
+
+    struct glwall_render_target checker_targets[2];
+    int checker_parity;
+    bool checker_history_valid;
+
+    struct glwall_render_target tile_target;
+    int tile_count;
+    int tile_next;
+    double tile_frame_ms;
+    float tile_time_sec;
+    float tile_dt_sec;
+    int tile_frame;
+
+    struct glwall_render_target share_target;
+    struct glwall_render_target keyframe_targets[2];
+    float keyframe_time[2];
+    int keyframe_newest;
+    int keyframe_count;
+    bool share_frame_valid;
+    struct glwall_render_thread *render_thread;
+    char *connector;
+    struct wl_buffer *snapshot_buffer;
+    bool snapshot_shown;
+    uint64_t snapshot_due_ns;
+    GLuint snapshot_pbo;
+    GLsync snapshot_fence;
+    int32_t snapshot_width_px;
+    int32_t snapshot_height_px;
+    struct wl_buffer *pause_buffer;
+    bool pause_pending;
+    bool deep_paused;
+    GLuint capture_pbo;
+    GLsync capture_fence;
+    int32_t capture_width_px;
+    int32_t capture_height_px;
+    int capture_seen;
+    struct glwall_gpu_timer frame_timer;
+    struct glwall_contention contention;
+    struct glwall_hud_history hud_history;
+    struct glwall_present_pending present_pending[GLWALL_PRESENT_PENDING];
+    struct glwall_frame_stats frame_stats;
+    pthread_mutex_t frame_stats_lock;
     struct wl_callback_listener frame_listener;
     struct glwall_output *next;
 };
@@ -78,6 +200,35 @@ struct glwall_state {
     bool debug;
 
     enum glwall_power_mode power_mode;
+    int32_t fps_cap;
+    float render_scale;
+    float dynres_budget_ms;
+    float dynres_min_scale;
+    float dynres_max_scale;
+    bool checkerboard;
+    float tile_budget_ms;
+    bool output_sharing;
+    bool render_threads;
+    struct glwall_render_publisher *render_publisher;
+    bool headless;
+    int32_t headless_width;
+    int32_t headless_height;
+    int32_t headless_frames;
+    const char *headless_output;
+    bool benchmark;
+    int32_t benchmark_warmup;
+    const char *benchmark_output;
+    double shader_build_ms;
+    const char *record_path;
+    const char *replay_path;
+    struct glwall_replay *replay;
+    bool snapshot;
+    char *snapshot_dir;
+    struct glwall_snapshot_writer *snapshot_writer;
+    struct glwall_capture *capture;
+    struct glwall_gpu_mem gpu_mem;
+    bool hud;
+    bool cooperative;
     enum glwall_mouse_overlay_mode mouse_overlay_mode;
     int32_t mouse_overlay_edge_height_px;
     bool audio_enabled;
@@ -86,22 +237,37 @@ struct glwall_state {
     bool allow_vertex_shaders;
     const char *vertex_shader_path;
     int32_t vertex_count;
+    int32_t vertex_min_count;
+    float vertex_budget_ms;
+    bool particle_state;
+    int32_t keyframe_fps;
     GLenum vertex_draw_mode;
     bool kernel_input_enabled;
     uint32_t layer;
+    const char *render_device;
+    bool transparent;
+    bool opaque;
 
     struct wl_display *display;
     struct wl_registry *registry;
     struct wl_compositor *compositor;
+    struct wl_shm *shm;
     struct zwlr_layer_shell_v1 *layer_shell;
+    struct wp_viewporter *viewporter;
+    struct wp_fractional_scale_manager_v1 *fractional_scale_manager;
+    struct wp_presentation *presentation;
+    uint32_t presentation_clock;
     struct wl_seat *seat;
     struct wl_pointer *pointer;
 
     EGLDisplay egl_display;
     EGLConfig egl_config;
     EGLContext egl_context;
+    bool egl_low_priority;
 
-    GLuint shader_program;
+    struct glwall_user_program user_program;
+    char *user_vert_src;
+    char *user_frag_src;
     GLuint vao;
     GLuint ubo_state;
     GLuint pass_ubo;
@@ -110,19 +276,23 @@ struct glwall_state {
     GLuint source_image_texture;
     int32_t source_image_width_px;
     int32_t source_image_height_px;
-    GLint loc_resolution;
-    GLint loc_resolution_vec2;
-    GLint loc_time;
-    GLint loc_time_delta;
-    GLint loc_frame;
-    GLint loc_mouse;
-    GLint loc_mouse_vec2;
-    GLint loc_sound;
-    GLint loc_sound_res;
-    GLint loc_vertex_count;
+    GLint loc_checker_parity;
+
+    GLuint checker_resolve_program;
+    GLint loc_checker_resolve_parity;
+    GLint loc_checker_history_valid;
+    GLuint keyframe_blend_program;
+    GLint loc_keyframe_mix;
+
+    GLuint hud_program;
+    GLuint hud_texture;
+    struct glwall_hud_canvas hud_canvas;
 
     struct glwall_pipeline *pipeline;
 
+    uint32_t shader_needs;
+    bool render_once;
+
     struct glwall_output *outputs;
 
     struct glwall_output *pointer_output;
@@ -131,6 +301,7 @@ struct glwall_state {
     double pointer_down_x;
     double pointer_down_y;
     bool pointer_down;
+    bool pointer_global;
 
     struct glwall_audio_state audio;
 
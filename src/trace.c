@@ -0,0 +1,184 @@
+#include "trace.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define TRACE_MAGIC "GLWTRACE"
+#define TRACE_VERSION 1u
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 52
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void put_f32(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put_u32(p, v);
+}
+
+static float get_f32(const uint8_t *p) {
+    uint32_t v = get_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static void put_f64(uint8_t *p, double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    put_u64(p, v);
+}
+
+static double get_f64(const uint8_t *p) {
+    uint64_t v = get_u64(p);
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+bool trace_open_write(struct glwall_trace *trace, const char *path) {
+    assert(trace != NULL);
+
+    memset(trace, 0, sizeof(*trace));
+    trace->fp = fopen(path, "wb");
+    if (!trace->fp)
+        return false;
+    trace->writing = true;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, 8);
+    put_u32(header + 8, TRACE_VERSION);
+    put_u32(header + 12, GLWALL_TRACE_AUDIO_SAMPLES);
+    if (fwrite(header, 1, sizeof(header), trace->fp) != sizeof(header)) {
+        trace_close(trace);
+        return false;
+    }
+    return true;
+}
+
+bool trace_open_read(struct glwall_trace *trace, const char *path) {
+    assert(trace != NULL);
+
+    memset(trace, 0, sizeof(*trace));
+    trace->fp = fopen(path, "rb");
+    if (!trace->fp)
+        return false;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), trace->fp) != sizeof(header) ||
+        memcmp(header, TRACE_MAGIC, 8) != 0 || get_u32(header + 8) != TRACE_VERSION ||
+        get_u32(header + 12) != GLWALL_TRACE_AUDIO_SAMPLES) {
+        trace_close(trace);
+        return false;
+    }
+    return true;
+}
+
+static bool trace_flush(struct glwall_trace *trace) {
+    if (fflush(trace->fp) != 0) {
+        trace->error = true;
+        return false;
+    }
+    return true;
+}
+
+bool trace_write_frame(struct glwall_trace *trace, const struct glwall_trace_frame *frame) {
+    assert(trace != NULL && trace->writing);
+    assert(frame != NULL);
+
+    uint8_t rec[TRACE_RECORD_SIZE];
+    put_f32(rec + 0, frame->time_sec);
+    put_f32(rec + 4, frame->dt_sec);
+    put_u32(rec + 8, (uint32_t)frame->frame);
+    put_u32(rec + 12, (uint32_t)frame->pointer_output);
+    put_f64(rec + 16, frame->pointer_x);
+    put_f64(rec + 24, frame->pointer_y);
+    put_f64(rec + 32, frame->pointer_down_x);
+    put_f64(rec + 40, frame->pointer_down_y);
+    rec[48] = frame->pointer_down;
+    rec[49] = frame->pointer_global;
+    rec[50] = frame->has_audio;
+    rec[51] = 0;
+    if (fwrite(rec, 1, sizeof(rec), trace->fp) != sizeof(rec)) {
+        trace->error = true;
+        return false;
+    }
+    if (!frame->has_audio)
+        return trace_flush(trace);
+
+    uint8_t audio[GLWALL_TRACE_AUDIO_SAMPLES * 2];
+    for (int i = 0; i < GLWALL_TRACE_AUDIO_SAMPLES; i++) {
+        uint16_t s = (uint16_t)frame->audio[i];
+        audio[2 * i] = (uint8_t)s;
+        audio[2 * i + 1] = (uint8_t)(s >> 8);
+    }
+    if (fwrite(audio, 1, sizeof(audio), trace->fp) != sizeof(audio)) {
+        trace->error = true;
+        return false;
+    }
+    return trace_flush(trace);
+}
+
+bool trace_read_frame(struct glwall_trace *trace, struct glwall_trace_frame *frame) {
+    assert(trace != NULL && !trace->writing);
+    assert(frame != NULL);
+
+    uint8_t rec[TRACE_RECORD_SIZE];
+    size_t got = fread(rec, 1, sizeof(rec), trace->fp);
+    if (got != sizeof(rec)) {
+        trace->error = got != 0;
+        return false;
+    }
+    frame->time_sec = get_f32(rec + 0);
+    frame->dt_sec = get_f32(rec + 4);
+    frame->frame = (int32_t)get_u32(rec + 8);
+    frame->pointer_output = (int32_t)get_u32(rec + 12);
+    frame->pointer_x = get_f64(rec + 16);
+    frame->pointer_y = get_f64(rec + 24);
+    frame->pointer_down_x = get_f64(rec + 32);
+    frame->pointer_down_y = get_f64(rec + 40);
+    frame->pointer_down = rec[48] != 0;
+    frame->pointer_global = rec[49] != 0;
+    frame->has_audio = rec[50] != 0;
+    if (!frame->has_audio)
+        return true;
+
+    uint8_t audio[GLWALL_TRACE_AUDIO_SAMPLES * 2];
+    if (fread(audio, 1, sizeof(audio), trace->fp) != sizeof(audio)) {
+        trace->error = true;
+        return false;
+    }
+    for (int i = 0; i < GLWALL_TRACE_AUDIO_SAMPLES; i++)
+        frame->audio[i] = (int16_t)(uint16_t)(audio[2 * i] | (audio[2 * i + 1] << 8));
+    return true;
+}
+
+bool trace_close(struct glwall_trace *trace) {
+    if (!trace || !trace->fp)
+        return true;
+    bool ok = fclose(trace->fp) == 0 && !trace->error;
+    trace->fp = NULL;
+    return ok;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define GLWALL_TRACE_AUDIO_SAMPLES 512
+
+struct glwall_trace_frame {
+    float time_sec;
+    float dt_sec;
+    int32_t frame;
+    int32_t pointer_output;
+    double pointer_x;
+    double pointer_y;
+    double pointer_down_x;
+    double pointer_down_y;
+    bool pointer_down;
+    bool pointer_global;
+    bool has_audio;
+    int16_t audio[GLWALL_TRACE_AUDIO_SAMPLES];
+};
+
+struct glwall_trace {
+    FILE *fp;
+    bool writing;
+    bool error;
+};
+
+bool trace_open_write(struct glwall_trace *trace, const char *path);
+
+bool trace_open_read(struct glwall_trace *trace, const char *path);
+
+bool trace_write_frame(struct glwall_trace *trace, const struct glwall_trace_frame *frame);
+
+bool trace_read_frame(struct glwall_trace *trace, struct glwall_trace_frame *frame);
+
+bool trace_close(struct glwall_trace *trace);
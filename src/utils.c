@@ -1,12 +1,17 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "utils.h"
 #include <assert.h>
 #include <errno.h>
 #include <getopt.h>
 #include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define READ_FILE_MAX_SIZE (10 * 1024 * 1024)
 
@@ -90,7 +95,44 @@ char *read_file(const char *path) {
     return buffer;
 }
 
+uint64_t monotonic_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static volatile sig_atomic_t glwall_quit_flag = 0;
+
+static void glwall_quit_signal_handler(int sig) {
+    (void)sig;
+    glwall_quit_flag = 1;
+}
+
+void install_quit_handlers(void) {
+    struct sigaction action = {0};
+    action.sa_handler = glwall_quit_signal_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+void block_quit_signals(bool block) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+bool quit_requested(void) { return glwall_quit_flag != 0; }
+
 #define MAX_VERTEX_COUNT (1 << 20)
+#define DEFAULT_VERTEX_MIN_COUNT 4096
+#define MAX_FPS_CAP 1000
+#define MIN_RENDER_SCALE 0.1f
+#define MAX_RENDER_SCALE 2.0f
+#define MAX_BUDGET_MS 1000.0f
+#define MAX_HEADLESS_SIZE 16384
 
 void parse_options(int argc, char *argv[], struct glwall_state *state) {
     assert(argv != NULL);
@@ -111,8 +153,35 @@ void parse_options(int argc, char *argv[], struct glwall_state *state) {
                                     {"allow-vertex-shaders", no_argument, 0, 'V'},
                                     {"vertex-count", required_argument, 0, 4},
                                     {"vertex-mode", required_argument, 0, 7},
+                                    {"vertex-budget", required_argument, 0, 30},
+                                    {"vertex-min-count", required_argument, 0, 31},
+                                    {"particle-state", no_argument, 0, 32},
+                                    {"keyframe-fps", required_argument, 0, 33},
                                     {"kernel-input", no_argument, 0, 8},
                                     {"layer", required_argument, 0, 9},
+                                    {"fps", required_argument, 0, 10},
+                                    {"render-scale", required_argument, 0, 11},
+                                    {"dynres-budget", required_argument, 0, 12},
+                                    {"dynres-min-scale", required_argument, 0, 13},
+                                    {"dynres-max-scale", required_argument, 0, 14},
+                                    {"checkerboard", no_argument, 0, 15},
+                                    {"tile-budget", required_argument, 0, 16},
+                                    {"no-output-sharing", no_argument, 0, 17},
+                                    {"render-threads", no_argument, 0, 18},
+                                    {"headless", required_argument, 0, 19},
+                                    {"headless-frames", required_argument, 0, 20},
+                                    {"headless-output", required_argument, 0, 21},
+                                    {"frames", required_argument, 0, 20},
+                                    {"benchmark", no_argument, 0, 22},
+                                    {"warmup", required_argument, 0, 23},
+                                    {"benchmark-output", required_argument, 0, 24},
+                                    {"record", required_argument, 0, 25},
+                                    {"replay", required_argument, 0, 26},
+                                    {"no-snapshot", no_argument, 0, 27},
+                                    {"hud", no_argument, 0, 28},
+                                    {"cooperative", no_argument, 0, 29},
+                                    {"render-device", required_argument, 0, 34},
+                                    {"transparent", no_argument, 0, 35},
                                     {0, 0, 0, 0}};
     int c;
     while ((c = getopt_long(argc, argv, "s:i:dp:m:v:V", long_options, NULL)) != -1) {
@@ -139,10 +208,13 @@ void parse_options(int argc, char *argv[], struct glwall_state *state) {
             } else if (strcmp(optarg, "paused") == 0) {
                 state->power_mode = GLWALL_POWER_MODE_PAUSED;
                 LOG_DEBUG(state, "%s", "Configuration: power mode set to paused");
+            } else if (strcmp(optarg, "deep-paused") == 0) {
+                state->power_mode = GLWALL_POWER_MODE_DEEP_PAUSED;
+                LOG_DEBUG(state, "%s", "Configuration: power mode set to deep-paused");
             } else {
-                LOG_ERROR(
-                    "Configuration error: invalid power mode '%s' (valid: full|throttled|paused)",
-                    optarg);
+                LOG_ERROR("Configuration error: invalid power mode '%s' (valid: "
+                          "full|throttled|paused|deep-paused)",
+                          optarg);
                 exit(EXIT_FAILURE);
             }
             break;
@@ -235,6 +307,23 @@ void parse_options(int argc, char *argv[], struct glwall_state *state) {
             LOG_DEBUG(state, "Configuration: vertex count set to %ld", v);
             break;
         }
+        case 31: {
+            char *endptr;
+            long v = strtol(optarg, &endptr, 10);
+            if (endptr == optarg || v <= 0 || v > MAX_VERTEX_COUNT) {
+                LOG_ERROR("Configuration error: vertex-min-count must be between 1 and %d "
+                          "(received: '%s')",
+                          MAX_VERTEX_COUNT, optarg);
+                exit(EXIT_FAILURE);
+            }
+            state->vertex_min_count = (int32_t)v;
+            LOG_DEBUG(state, "Configuration: minimum vertex count set to %ld", v);
+            break;
+        }
+        case 32:
+            state->particle_state = true;
+            LOG_DEBUG(state, "%s", "Configuration: transform feedback particle state enabled");
+            break;
         case 7:
             if (strcmp(optarg, "points") == 0) {
                 state->vertex_draw_mode = GL_POINTS;
@@ -269,19 +358,213 @@ void parse_options(int argc, char *argv[], struct glwall_state *state) {
             }
             LOG_DEBUG(state, "Configuration: layer set to '%s'", optarg);
             break;
+        case 10:
+        case 33: {
+            char *endptr;
+            long fps = strtol(optarg, &endptr, 10);
+            if (endptr == optarg) {
+                LOG_ERROR("%s", "Configuration error: fps is not a number");
+                exit(EXIT_FAILURE);
+            }
+            if (fps < 0 || fps > MAX_FPS_CAP) {
+                LOG_ERROR("Configuration error: fps must be between 0 and %d (received: %ld)",
+                          MAX_FPS_CAP, fps);
+                exit(EXIT_FAILURE);
+            }
+            if (c == 10) {
+                state->fps_cap = (int32_t)fps;
+                LOG_DEBUG(state, "Configuration: frame rate cap set to %ld fps", fps);
+            } else {
+                state->keyframe_fps = (int32_t)fps;
+                LOG_DEBUG(state, "Configuration: keyframe rate set to %ld fps", fps);
+            }
+            break;
+        }
+        case 11: {
+            char *endptr;
+            float scale = strtof(optarg, &endptr);
+            if (endptr == optarg) {
+                LOG_ERROR("%s", "Configuration error: render scale is not a number");
+                exit(EXIT_FAILURE);
+            }
+            if (scale < MIN_RENDER_SCALE || scale > MAX_RENDER_SCALE) {
+                LOG_ERROR("Configuration error: render scale must be between %.1f and %.1f "
+                          "(received: %.3f)",
+                          MIN_RENDER_SCALE, MAX_RENDER_SCALE, scale);
+                exit(EXIT_FAILURE);
+            }
+            state->render_scale = scale;
+            LOG_DEBUG(state, "Configuration: render scale set to %.3f", scale);
+            break;
+        }
+        case 12:
+        case 16:
+        case 30: {
+            char *endptr;
+            float budget = strtof(optarg, &endptr);
+            if (endptr == optarg || budget < 0.0f || budget > MAX_BUDGET_MS) {
+                LOG_ERROR("Configuration error: GPU budget must be between 0 and %.0f ms "
+                          "(received: '%s')",
+                          MAX_BUDGET_MS, optarg);
+                exit(EXIT_FAILURE);
+            }
+            if (c == 12)
+                state->dynres_budget_ms = budget;
+            else if (c == 16)
+                state->tile_budget_ms = budget;
+            else
+                state->vertex_budget_ms = budget;
+            LOG_DEBUG(state, "Configuration: %s budget set to %.2f ms",
+                      c == 12 ? "dynamic resolution" : c == 16 ? "tile" : "vertex", budget);
+            break;
+        }
+        case 13:
+        case 14: {
+            char *endptr;
+            float scale = strtof(optarg, &endptr);
+            if (endptr == optarg || scale < MIN_RENDER_SCALE || scale > MAX_RENDER_SCALE) {
+                LOG_ERROR("Configuration error: dynres scale must be between %.1f and %.1f "
+                          "(received: '%s')",
+                          MIN_RENDER_SCALE, MAX_RENDER_SCALE, optarg);
+                exit(EXIT_FAILURE);
+            }
+            if (c == 13)
+                state->dynres_min_scale = scale;
+            else
+                state->dynres_max_scale = scale;
+            LOG_DEBUG(state, "Configuration: dynres %s scale set to %.3f", c == 13 ? "min" : "max",
+                      scale);
+            break;
+        }
+        case 15:
+            state->checkerboard = true;
+            LOG_DEBUG(state, "%s", "Configuration: checkerboard rendering enabled");
+            break;
+        case 17:
+            state->output_sharing = false;
+            LOG_DEBUG(state, "%s", "Configuration: output sharing disabled");
+            break;
+        case 18:
+            state->render_threads = true;
+            LOG_DEBUG(state, "%s", "Configuration: per-output render threads enabled");
+            break;
+        case 19: {
+            int w = 0, h = 0;
+            char tail = '\0';
+            if (sscanf(optarg, "%dx%d%c", &w, &h, &tail) != 2 || w <= 0 || h <= 0 ||
+                w > MAX_HEADLESS_SIZE || h > MAX_HEADLESS_SIZE) {
+                LOG_ERROR("Configuration error: invalid headless size '%s' (expected WxH, at most "
+                          "%d per side)",
+                          optarg, MAX_HEADLESS_SIZE);
+                exit(EXIT_FAILURE);
+            }
+            state->headless = true;
+            state->headless_width = w;
+            state->headless_height = h;
+            LOG_DEBUG(state, "Configuration: headless rendering at %d x %d", w, h);
+            break;
+        }
+        case 20: {
+            char *endptr;
+            long frames = strtol(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0' || frames < 1 || frames > INT32_MAX) {
+                LOG_ERROR("Configuration error: invalid headless frame count '%s'", optarg);
+                exit(EXIT_FAILURE);
+            }
+            state->headless_frames = (int32_t)frames;
+            LOG_DEBUG(state, "Configuration: headless frame count set to %ld", frames);
+            break;
+        }
+        case 21:
+            state->headless_output = optarg;
+            LOG_DEBUG(state, "Configuration: headless output path set to '%s'", optarg);
+            break;
+        case 22:
+            state->benchmark = true;
+            LOG_DEBUG(state, "%s", "Configuration: benchmark mode enabled");
+            break;
+        case 23: {
+            char *endptr;
+            long warmup = strtol(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0' || warmup < 0 || warmup > INT32_MAX) {
+                LOG_ERROR("Configuration error: invalid warmup frame count '%s'", optarg);
+                exit(EXIT_FAILURE);
+            }
+            state->benchmark_warmup = (int32_t)warmup;
+            LOG_DEBUG(state, "Configuration: benchmark warmup set to %ld frames", warmup);
+            break;
+        }
+        case 24:
+            state->benchmark_output = optarg;
+            LOG_DEBUG(state, "Configuration: benchmark report path set to '%s'", optarg);
+            break;
+        case 25:
+            state->record_path = optarg;
+            LOG_DEBUG(state, "Configuration: recording to '%s'", optarg);
+            break;
+        case 26:
+            state->replay_path = optarg;
+            LOG_DEBUG(state, "Configuration: replaying '%s'", optarg);
+            break;
+        case 27:
+            state->snapshot = false;
+            LOG_DEBUG(state, "%s", "Configuration: startup snapshot disabled");
+            break;
+        case 28:
+            state->hud = true;
+            LOG_DEBUG(state, "%s", "Configuration: frame timing HUD enabled");
+            break;
+        case 29:
+            state->cooperative = true;
+            LOG_DEBUG(state, "%s", "Configuration: cooperative GPU backoff enabled");
+            break;
+        case 34:
+            state->render_device = optarg;
+            LOG_DEBUG(state, "Configuration: render device set to '%s'", optarg);
+            break;
+        case 35:
+            state->transparent = true;
+            LOG_DEBUG(state, "%s", "Configuration: translucent output enabled");
+            break;
         default:
             fprintf(
                 stderr,
                 "Usage: %s -s <shader.frag|preset.slangp|preset.glslp> [--image path.png] "
-                "[--debug] \\\n+ [--power-mode full|throttled|paused] "
+                "[--debug] \\\n+ [--power-mode full|throttled|paused|deep-paused] "
                 "\\\n [--mouse-overlay none|edge|full] \\\n [--audio|--no-audio] [--audio-source "
                 "pulse|none] \\\n [--audio-device device-name] \\\n [--vertex-shader path "
-                "--allow-vertex-shaders] \\\n [--vertex-mode points|lines] \\\n [--kernel-input] "
-                "\\\n [--layer background|bottom|top|overlay]\n",
+                "--allow-vertex-shaders] \\\n [--vertex-mode points|lines] [--vertex-count N] \\\n"
+                " [--vertex-budget MS [--vertex-min-count N]] [--particle-state] \\\n"
+                " [--kernel-input] "
+                "\\\n [--layer background|bottom|top|overlay] [--fps N] "
+                "[--render-scale S] \\\n [--dynres-budget MS [--dynres-min-scale S] "
+                "[--dynres-max-scale S]] [--checkerboard] [--keyframe-fps N] "
+                "\\\n [--tile-budget MS] [--no-output-sharing] [--render-threads] \\\n"
+                " [--headless WxH [--headless-frames N] [--headless-output path]] \\\n"
+                " [--benchmark [--frames N] [--warmup M] [--benchmark-output path]] \\\n"
+                " [--record path | --replay path] [--no-snapshot] [--hud] [--cooperative] \\\n"
+                " [--render-device index|path|software] [--transparent]\n",
                 argv[0]);
             exit(EXIT_FAILURE);
         }
     }
+    if (state->dynres_min_scale > state->dynres_max_scale) {
+        LOG_ERROR("%s", "Configuration error: --dynres-min-scale exceeds --dynres-max-scale");
+        exit(EXIT_FAILURE);
+    }
+    if (state->vertex_min_count > state->vertex_count) {
+        LOG_ERROR("%s", "Configuration error: --vertex-min-count exceeds --vertex-count");
+        exit(EXIT_FAILURE);
+    }
+    if (state->vertex_min_count == 0) {
+        state->vertex_min_count =
+            state->vertex_count < DEFAULT_VERTEX_MIN_COUNT ? state->vertex_count
+                                                           : DEFAULT_VERTEX_MIN_COUNT;
+    }
+    state->opaque = !state->transparent &&
+                    (state->layer == ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND ||
+                     state->layer == ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM) &&
+                    state->mouse_overlay_mode == GLWALL_MOUSE_OVERLAY_NONE;
     if (!state->shader_path && !state->vertex_shader_path) {
         LOG_ERROR("%s",
                   "Configuration error: shader path is required (use -s /path/to/shader.frag)");
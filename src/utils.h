@@ -13,4 +13,12 @@
 
 char *read_file(const char *path);
 
+uint64_t monotonic_time_ns(void);
+
+void install_quit_handlers(void);
+
+void block_quit_signals(bool block);
+
+bool quit_requested(void);
+
 void parse_options(int argc, char *argv[], struct glwall_state *state);
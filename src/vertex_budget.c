@@ -0,0 +1,92 @@
+#include "vertex_budget.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#define VERTEX_BUDGET_AVG_WEIGHT 0.2
+#define VERTEX_BUDGET_OVER_RATIO 1.10
+#define VERTEX_BUDGET_UNDER_RATIO 0.75
+#define VERTEX_BUDGET_OVER_FRAMES 3
+#define VERTEX_BUDGET_UNDER_FRAMES 30
+#define VERTEX_BUDGET_COOLDOWN_FRAMES 8
+#define VERTEX_BUDGET_STEP_UP 1.10
+#define VERTEX_BUDGET_QUANTUM 64
+
+static int32_t clamp_count(const struct glwall_vertex_budget *budget, int64_t count) {
+    if (count < budget->min_count)
+        return budget->min_count;
+    if (count > budget->max_count)
+        return budget->max_count;
+    return (int32_t)count;
+}
+
+static bool apply_count(struct glwall_vertex_budget *budget, double target) {
+    int64_t steps = (int64_t)(target / VERTEX_BUDGET_QUANTUM);
+    if (target > budget->count)
+        steps++;
+    int32_t count = clamp_count(budget, steps * VERTEX_BUDGET_QUANTUM);
+    budget->over_count = 0;
+    budget->under_count = 0;
+    if (count == budget->count)
+        return false;
+
+    budget->avg_ms *= (double)count / (double)budget->count;
+    budget->count = count;
+    budget->cooldown = VERTEX_BUDGET_COOLDOWN_FRAMES;
+    return true;
+}
+
+void vertex_budget_init(struct glwall_vertex_budget *budget, float budget_ms, int32_t min_count,
+                        int32_t max_count) {
+    assert(budget != NULL);
+    assert(min_count > 0 && min_count <= max_count);
+
+    budget->budget_ms = budget_ms;
+    budget->min_count = min_count;
+    budget->max_count = max_count;
+    budget->count = max_count;
+    budget->avg_ms = 0.0;
+    budget->has_avg = false;
+    budget->over_count = 0;
+    budget->under_count = 0;
+    budget->cooldown = 0;
+}
+
+bool vertex_budget_update(struct glwall_vertex_budget *budget, double gpu_ms) {
+    assert(budget != NULL);
+
+    if (budget->budget_ms <= 0.0f || gpu_ms < 0.0)
+        return false;
+
+    if (budget->has_avg) {
+        budget->avg_ms += VERTEX_BUDGET_AVG_WEIGHT * (gpu_ms - budget->avg_ms);
+    } else {
+        budget->avg_ms = gpu_ms;
+        budget->has_avg = true;
+    }
+
+    if (budget->cooldown > 0) {
+        budget->cooldown--;
+        return false;
+    }
+
+    double limit = (double)budget->budget_ms;
+    if (budget->avg_ms > limit * VERTEX_BUDGET_OVER_RATIO) {
+        budget->over_count++;
+        budget->under_count = 0;
+    } else if (budget->avg_ms < limit * VERTEX_BUDGET_UNDER_RATIO) {
+        budget->under_count++;
+        budget->over_count = 0;
+    } else {
+        budget->over_count = 0;
+        budget->under_count = 0;
+    }
+
+    if (budget->over_count >= VERTEX_BUDGET_OVER_FRAMES && budget->count > budget->min_count) {
+        return apply_count(budget, budget->count * (limit / budget->avg_ms));
+    }
+    if (budget->under_count >= VERTEX_BUDGET_UNDER_FRAMES && budget->count < budget->max_count) {
+        return apply_count(budget, budget->count * VERTEX_BUDGET_STEP_UP);
+    }
+    return false;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct glwall_vertex_budget {
+    int32_t count;
+    int32_t min_count;
+    int32_t max_count;
+    float budget_ms;
+    double avg_ms;
+    bool has_avg;
+    int over_count;
+    int under_count;
+    int cooldown;
+};
+
+void vertex_budget_init(struct glwall_vertex_budget *budget, float budget_ms, int32_t min_count,
+                        int32_t max_count);
+
+bool vertex_budget_update(struct glwall_vertex_budget *budget, double gpu_ms);
@@ -1,10 +1,22 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "wayland.h"
+#include "deep_pause.h"
 #include "opengl.h"
+#include "pipeline.h"
+#include "presentation.h"
+#include "render_thread.h"
+#include "scheduler.h"
+#include "snapshot.h"
 #include "utils.h"
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "fractional-scale-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+#include "viewporter-client-protocol.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 
 #define UNUSED(x) (void)(x)
@@ -17,6 +29,15 @@ static void registry_handle_global(void *data, struct wl_registry *registry, uin
                                    const char *interface, uint32_t version);
 static void registry_handle_global_remove(void *data, struct wl_registry *registry, uint32_t name);
 
+static void output_handle_geometry(void *data, struct wl_output *wl_output, int32_t x, int32_t y,
+                                   int32_t physical_width, int32_t physical_height,
+                                   int32_t subpixel, const char *make, const char *model,
+                                   int32_t transform);
+static void output_handle_mode(void *data, struct wl_output *wl_output, uint32_t flags,
+                               int32_t width, int32_t height, int32_t refresh);
+static void output_handle_done(void *data, struct wl_output *wl_output);
+static void output_handle_scale(void *data, struct wl_output *wl_output, int32_t factor);
+
 static void seat_handle_capabilities(void *data, struct wl_seat *seat, uint32_t caps);
 static void seat_handle_name(void *data, struct wl_seat *seat, const char *name);
 
@@ -44,6 +65,7 @@ static void frame_done(void *data, struct wl_callback *cb, uint32_t time) {
     LOG_DEBUG(output->state, "Wayland event: frame_done callback invoked for output %u",
               output->output_name);
     wl_callback_destroy(cb);
+    output->frame_scheduled = false;
     render_frame(output);
 }
 
@@ -51,6 +73,70 @@ const struct wl_callback_listener frame_listener = {
     .done = frame_done,
 };
 
+static bool output_update_buffer_size(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (output->logical_width <= 0 || output->logical_height <= 0)
+        return false;
+
+    int32_t width_px, height_px;
+    if (output->viewport) {
+        double scale = output->preferred_scale_120 > 0 ? output->preferred_scale_120 / 120.0
+                                                       : (double)output->scale;
+        width_px = (int32_t)lround(lround(output->logical_width * scale) * state->render_scale);
+        height_px = (int32_t)lround(lround(output->logical_height * scale) * state->render_scale);
+        width_px = width_px > 0 ? width_px : 1;
+        height_px = height_px > 0 ? height_px : 1;
+        wp_viewport_set_destination(output->viewport, output->logical_width,
+                                    output->logical_height);
+    } else {
+        width_px = output->logical_width * output->scale;
+        height_px = output->logical_height * output->scale;
+        wl_surface_set_buffer_scale(output->wl_surface, output->scale);
+    }
+
+    if (width_px == output->width_px && height_px == output->height_px)
+        return false;
+
+    LOG_DEBUG(state, "Display subsystem: output %u buffer %d x %d (logical %d x %d)",
+              output->output_name, width_px, height_px, output->logical_width,
+              output->logical_height);
+    output->width_px = width_px;
+    output->height_px = height_px;
+    contention_reset(&output->contention);
+    if (output->render_thread) {
+        render_thread_update(output);
+    } else if (output->wl_egl_window) {
+        LOG_DEBUG(state, "EGL subsystem: EGL window resize operation initiated for output %u",
+                  output->output_name);
+        wl_egl_window_resize(output->wl_egl_window, width_px, height_px, 0, 0);
+    }
+    return true;
+}
+
+static void output_rescale(struct glwall_output *output) {
+    struct glwall_state *state = output->state;
+    if (!output_update_buffer_size(output) || !output->configured)
+        return;
+    if ((state->render_once || output->deep_paused) &&
+        (state->user_program.program != 0 || pipeline_is_active(state)))
+        render_frame(output);
+}
+
+static void fractional_scale_handle_preferred_scale(void *data,
+                                                    struct wp_fractional_scale_v1 *fractional_scale,
+                                                    uint32_t scale) {
+    UNUSED(fractional_scale);
+    struct glwall_output *output = data;
+    LOG_DEBUG(output->state, "Wayland event: output %u preferred scale %.3f", output->output_name,
+              scale / 120.0);
+    output->preferred_scale_120 = scale;
+    output_rescale(output);
+}
+
+static const struct wp_fractional_scale_v1_listener fractional_scale_listener = {
+    .preferred_scale = fractional_scale_handle_preferred_scale,
+};
+
 static void layer_surface_configure(void *data, struct zwlr_layer_surface_v1 *surface,
                                     uint32_t serial, uint32_t w, uint32_t h) {
     struct glwall_output *output = data;
@@ -62,21 +148,26 @@ static void layer_surface_configure(void *data, struct zwlr_layer_surface_v1 *su
 
     if (surface == output->layer_surface) {
 
-        output->width_px = w;
-        output->height_px = h;
+        output->logical_width = (int32_t)w;
+        output->logical_height = (int32_t)h;
+        output_update_buffer_size(output);
         output->configured = true;
 
-        if (output->wl_egl_window) {
-            LOG_DEBUG(state, "EGL subsystem: EGL window resize operation initiated for output %u",
-                      output->output_name);
-            wl_egl_window_resize(output->wl_egl_window, w, h, 0, 0);
-        }
-
         zwlr_layer_surface_v1_ack_configure(surface, serial);
         LOG_DEBUG(state, "Wayland protocol: configure acknowledgment sent for output %u",
                   output->output_name);
+        if (state->opaque && state->compositor) {
+            struct wl_region *opaque = wl_compositor_create_region(state->compositor);
+            if (opaque) {
+                wl_region_add(opaque, 0, 0, (int32_t)w, (int32_t)h);
+                wl_surface_set_opaque_region(output->wl_surface, opaque);
+                wl_region_destroy(opaque);
+            }
+        }
+        if (state->user_program.program == 0 && !pipeline_is_active(state))
+            snapshot_present(output);
 
-        if (state->shader_program != 0) {
+        if (state->user_program.program != 0 || pipeline_is_active(state)) {
             LOG_DEBUG(
                 state,
                 "Render cycle: re-render triggered for output %u (OpenGL ready, configure event)",
@@ -130,6 +221,74 @@ static const struct zwlr_layer_surface_v1_listener layer_surface_listener = {
     .closed = layer_surface_closed,
 };
 
+static void output_handle_geometry(void *data, struct wl_output *wl_output, int32_t x, int32_t y,
+                                   int32_t physical_width, int32_t physical_height,
+                                   int32_t subpixel, const char *make, const char *model,
+                                   int32_t transform) {
+    UNUSED(data);
+    UNUSED(wl_output);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(physical_width);
+    UNUSED(physical_height);
+    UNUSED(subpixel);
+    UNUSED(make);
+    UNUSED(model);
+    UNUSED(transform);
+}
+
+static void output_handle_mode(void *data, struct wl_output *wl_output, uint32_t flags,
+                               int32_t width, int32_t height, int32_t refresh) {
+    UNUSED(wl_output);
+    struct glwall_output *output = data;
+    if (!(flags & WL_OUTPUT_MODE_CURRENT))
+        return;
+
+    output->refresh_mhz = refresh;
+    LOG_DEBUG(output->state, "Wayland event: output %u mode %d x %d @ %.3f Hz",
+              output->output_name, width, height, refresh / 1000.0);
+    if (output->render_thread)
+        render_thread_update(output);
+}
+
+static void output_handle_done(void *data, struct wl_output *wl_output) {
+    UNUSED(data);
+    UNUSED(wl_output);
+}
+
+static void output_handle_name(void *data, struct wl_output *wl_output, const char *name) {
+    UNUSED(wl_output);
+    struct glwall_output *output = data;
+    free(output->connector);
+    output->connector = strdup(name);
+}
+
+static void output_handle_description(void *data, struct wl_output *wl_output,
+                                      const char *description) {
+    UNUSED(data);
+    UNUSED(wl_output);
+    UNUSED(description);
+}
+
+static void output_handle_scale(void *data, struct wl_output *wl_output, int32_t factor) {
+    UNUSED(wl_output);
+    struct glwall_output *output = data;
+    output->scale = factor > 0 ? factor : 1;
+    LOG_DEBUG(output->state, "Wayland event: output %u scale %d", output->output_name,
+              output->scale);
+    if (output->preferred_scale_120 == 0)
+        output_rescale(output);
+}
+
+static const struct wl_output_listener output_listener = {
+    .geometry = output_handle_geometry,
+    .mode = output_handle_mode,
+    .done = output_handle_done,
+    .scale = output_handle_scale,
+    .name = output_handle_name,
+    .description = output_handle_description,
+};
+
 static const struct wl_seat_listener seat_listener = {
     .capabilities = seat_handle_capabilities,
     .name = seat_handle_name,
@@ -159,6 +318,10 @@ static void registry_handle_global(void *data, struct wl_registry *registry, uin
     if (strcmp(interface, wl_compositor_interface.name) == 0) {
         LOG_DEBUG(state, "%s", "Wayland protocol: binding wl_compositor");
         state->compositor = wl_registry_bind(registry, name, &wl_compositor_interface, 4);
+    } else if (strcmp(interface, wl_shm_interface.name) == 0 &&
+               (state->snapshot || state->power_mode == GLWALL_POWER_MODE_DEEP_PAUSED)) {
+        LOG_DEBUG(state, "%s", "Wayland protocol: binding wl_shm");
+        state->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
     } else if (strcmp(interface, wl_seat_interface.name) == 0) {
         LOG_DEBUG(state, "Wayland protocol: binding wl_seat (name: %u)", name);
         state->seat = wl_registry_bind(registry, name, &wl_seat_interface, 1);
@@ -176,6 +339,16 @@ static void registry_handle_global(void *data, struct wl_registry *registry, uin
                   version, zwlr_layer_shell_v1_interface.version, bind_version);
         state->layer_shell =
             wl_registry_bind(registry, name, &zwlr_layer_shell_v1_interface, bind_version);
+    } else if (strcmp(interface, wp_viewporter_interface.name) == 0) {
+        LOG_DEBUG(state, "%s", "Wayland protocol: binding wp_viewporter");
+        state->viewporter = wl_registry_bind(registry, name, &wp_viewporter_interface, 1);
+    } else if (strcmp(interface, wp_fractional_scale_manager_v1_interface.name) == 0) {
+        LOG_DEBUG(state, "%s", "Wayland protocol: binding wp_fractional_scale_manager_v1");
+        state->fractional_scale_manager =
+            wl_registry_bind(registry, name, &wp_fractional_scale_manager_v1_interface, 1);
+    } else if (strcmp(interface, wp_presentation_interface.name) == 0) {
+        LOG_DEBUG(state, "%s", "Wayland protocol: binding wp_presentation");
+        presentation_attach(state, wl_registry_bind(registry, name, &wp_presentation_interface, 1));
     } else if (strcmp(interface, wl_output_interface.name) == 0) {
         LOG_DEBUG(state, "Wayland protocol: binding wl_output (name: %u)", name);
         struct glwall_output *output = calloc(1, sizeof(struct glwall_output));
@@ -185,7 +358,13 @@ static void registry_handle_global(void *data, struct wl_registry *registry, uin
         }
         output->state = state;
         output->output_name = name;
-        output->wl_output = wl_registry_bind(registry, name, &wl_output_interface, 1);
+        output->timer_fd = -1;
+        output->scale = 1;
+        presentation_init_output(output);
+        uint32_t bind_version = version < 4 ? version : 4;
+        output->wl_output = wl_registry_bind(registry, name, &wl_output_interface, bind_version);
+        if (output->wl_output)
+            wl_output_add_listener(output->wl_output, &output_listener, output);
         output->next = state->outputs;
         state->outputs = output;
         LOG_INFO("Display subsystem: output %u detected", name);
@@ -361,6 +540,10 @@ bool init_wayland(struct glwall_state *state) {
                         "or wlr_layer_shell)");
         return false;
     }
+
+    if (!state->viewporter && state->render_scale != 1.0f) {
+        LOG_WARN("%s", "wp_viewporter unavailable; --render-scale ignored");
+    }
     return true;
 }
 
@@ -375,10 +558,19 @@ void create_layer_surfaces(struct glwall_state *state) {
     for (struct glwall_output *output = state->outputs; output; output = output->next) {
 
         output->wl_surface = wl_compositor_create_surface(state->compositor);
+        if (state->viewporter)
+            output->viewport = wp_viewporter_get_viewport(state->viewporter, output->wl_surface);
+        if (state->viewporter && state->fractional_scale_manager) {
+            output->fractional_scale = wp_fractional_scale_manager_v1_get_fractional_scale(
+                state->fractional_scale_manager, output->wl_surface);
+            wp_fractional_scale_v1_add_listener(output->fractional_scale,
+                                                &fractional_scale_listener, output);
+        }
         output->layer_surface = zwlr_layer_shell_v1_get_layer_surface(
             state->layer_shell, output->wl_surface, output->wl_output, state->layer, "glwall");
 
         zwlr_layer_surface_v1_add_listener(output->layer_surface, &layer_surface_listener, output);
+        scheduler_init_output(output);
 
         output->wl_egl_window = wl_egl_window_create(output->wl_surface, 1, 1);
         if (!output->wl_egl_window) {
@@ -432,6 +624,8 @@ void create_layer_surfaces(struct glwall_state *state) {
 
 void start_rendering(struct glwall_state *state) {
     LOG_INFO("%s", "Render cycle: initialization complete, rendering commenced");
+    if (state->render_threads && render_threads_start(state))
+        return;
     for (struct glwall_output *output = state->outputs; output; output = output->next) {
         if (output->configured) {
 
@@ -443,20 +637,37 @@ void start_rendering(struct glwall_state *state) {
 void cleanup_wayland(struct glwall_state *state) {
     struct glwall_output *output = state->outputs;
     while (output) {
+        scheduler_cleanup_output(output);
+        presentation_cleanup_output(output);
+        snapshot_cleanup_output(output);
+        deep_pause_cleanup_output(output);
         if (output->overlay_layer_surface)
             zwlr_layer_surface_v1_destroy(output->overlay_layer_surface);
         if (output->overlay_surface)
             wl_surface_destroy(output->overlay_surface);
         if (output->layer_surface)
             zwlr_layer_surface_v1_destroy(output->layer_surface);
+        if (output->fractional_scale)
+            wp_fractional_scale_v1_destroy(output->fractional_scale);
+        if (output->viewport)
+            wp_viewport_destroy(output->viewport);
         if (output->wl_surface)
             wl_surface_destroy(output->wl_surface);
         if (output->wl_output)
             wl_output_destroy(output->wl_output);
         struct glwall_output *next = output->next;
+        free(output->connector);
         free(output);
         output = next;
     }
+    if (state->presentation)
+        wp_presentation_destroy(state->presentation);
+    if (state->shm)
+        wl_shm_destroy(state->shm);
+    if (state->fractional_scale_manager)
+        wp_fractional_scale_manager_v1_destroy(state->fractional_scale_manager);
+    if (state->viewporter)
+        wp_viewporter_destroy(state->viewporter);
     if (state->layer_shell)
         zwlr_layer_shell_v1_destroy(state->layer_shell);
     if (state->compositor)
@@ -0,0 +1,50 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../src/bench_stats.h"
+
+static int expect(const char *what, double got, double want) {
+    if (fabs(got - want) > 1e-9) {
+        fprintf(stderr, "%s: expected %.3f, got %.3f\n", what, want, got);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    struct glwall_bench_series s;
+    struct glwall_bench_summary sum;
+
+    if (!bench_series_init(&s, 100))
+        return 1;
+    for (int i = 100; i >= 1; i--)
+        bench_series_add(&s, (double)i);
+    bench_series_add(&s, 1000.0);
+    bench_series_summarize(&s, &sum);
+    int fail = 0;
+    fail |= expect("count", (double)sum.count, 100.0);
+    fail |= expect("min", sum.min, 1.0);
+    fail |= expect("p50", sum.p50, 50.0);
+    fail |= expect("p95", sum.p95, 95.0);
+    fail |= expect("p99", sum.p99, 99.0);
+    fail |= expect("max", sum.max, 100.0);
+    fail |= expect("mean", sum.mean, 50.5);
+    bench_series_free(&s);
+
+    bench_series_init(&s, 4);
+    bench_series_add(&s, 7.0);
+    bench_series_summarize(&s, &sum);
+    fail |= expect("single p99", sum.p99, 7.0);
+    fail |= expect("single p50", sum.p50, 7.0);
+    bench_series_free(&s);
+
+    bench_series_init(&s, 0);
+    bench_series_summarize(&s, &sum);
+    fail |= expect("empty count", (double)sum.count, 0.0);
+    bench_series_free(&s);
+
+    if (fail)
+        return 1;
+    printf("bench_stats: PASS\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+
+#include "../src/contention.h"
+
+static int run_frames(struct glwall_contention *c, double ms, int frames, int *changes) {
+    for (int i = 0; i < frames; i++) {
+        double jitter = ((i * 7) % 5 - 2) * 0.02 * ms;
+        if (contention_update(c, ms + jitter))
+            (*changes)++;
+    }
+    return c->level;
+}
+
+int main(void) {
+    struct glwall_contention c;
+    int changes = 0;
+
+    contention_reset(&c);
+    run_frames(&c, 4.0, 600, &changes);
+    if (c.level != 0 || changes != 0) {
+        fprintf(stderr, "steady: level %d after %d changes\n", c.level, changes);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&c, 9.0, 60, &changes);
+    if (c.level < 1) {
+        fprintf(stderr, "contended: no backoff (level %d)\n", c.level);
+        return 1;
+    }
+    run_frames(&c, 9.0, 300, &changes);
+    if (c.level != GLWALL_CONTENTION_MAX_LEVEL || changes != GLWALL_CONTENTION_MAX_LEVEL) {
+        fprintf(stderr, "contended: level %d after %d changes\n", c.level, changes);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&c, 4.0, 1200, &changes);
+    if (c.level != 0 || changes != GLWALL_CONTENTION_MAX_LEVEL) {
+        fprintf(stderr, "recovery: level %d after %d changes\n", c.level, changes);
+        return 1;
+    }
+
+    contention_reset(&c);
+    changes = 0;
+    run_frames(&c, 0.1, 300, &changes);
+    run_frames(&c, 0.4, 300, &changes);
+    if (c.level != 0 || changes != 0) {
+        fprintf(stderr, "tiny shader: level %d\n", c.level);
+        return 1;
+    }
+
+    contention_reset(&c);
+    changes = 0;
+    run_frames(&c, 4.0, 300, &changes);
+    run_frames(&c, 12.0, 3000, &changes);
+    if (c.level != 0) {
+        fprintf(stderr, "recalibration: still at level %d\n", c.level);
+        return 1;
+    }
+
+    printf("contention: PASS\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../src/dynres.h"
+
+static double frame_cost_ms(double full_res_ms, float scale) {
+    return full_res_ms * (double)scale * (double)scale;
+}
+
+static void run_frames(struct glwall_dynres *dr, double full_res_ms, int frames, int *changes) {
+    for (int i = 0; i < frames; i++) {
+        if (dynres_update(dr, frame_cost_ms(full_res_ms, dr->scale)))
+            (*changes)++;
+    }
+}
+
+int main(void) {
+    struct glwall_dynres dr;
+    int changes = 0;
+
+    dynres_init(&dr, 4.0f, 0.5f, 1.0f);
+    run_frames(&dr, 2.0, 600, &changes);
+    if (dr.scale != 1.0f || changes != 0) {
+        fprintf(stderr, "cheap scene: expected full scale, got %.3f (%d changes)\n", dr.scale,
+                changes);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&dr, 8.0, 600, &changes);
+    double cost = frame_cost_ms(8.0, dr.scale);
+    if (dr.scale >= 1.0f || cost > 4.0 * 1.10) {
+        fprintf(stderr, "expensive scene: scale %.3f cost %.3f ms over budget\n", dr.scale, cost);
+        return 1;
+    }
+    int settle_changes = changes;
+    changes = 0;
+    run_frames(&dr, 8.0, 1200, &changes);
+    if (changes > 1) {
+        fprintf(stderr, "expensive scene: oscillated (%d changes after settling %d)\n", changes,
+                settle_changes);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&dr, 100.0, 600, &changes);
+    if (dr.scale != 0.5f) {
+        fprintf(stderr, "overloaded scene: expected min scale, got %.3f\n", dr.scale);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&dr, 1.0, 3000, &changes);
+    if (dr.scale != 1.0f) {
+        fprintf(stderr, "recovered scene: expected full scale, got %.3f\n", dr.scale);
+        return 1;
+    }
+
+    printf("dynres controller: PASS\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+
+#include "../src/feature_compat.h"
+
+#define SHADER GLWALL_FEATURE_FRAGMENT
+#define VERTEX_SHADER GLWALL_FEATURE_VERTEX
+
+static int check(const char *name, uint32_t features, uint32_t expected) {
+    uint32_t fired;
+    uint32_t got = feature_compat_resolve(features, &fired);
+    if (got != expected) {
+        fprintf(stderr, "%s: got 0x%x, expected 0x%x (rules fired 0x%x)\n", name, got, expected,
+                fired);
+        return 1;
+    }
+    if ((got != features) != (fired != 0)) {
+        fprintf(stderr, "%s: rules fired 0x%x but features 0x%x -> 0x%x\n", name, fired, features,
+                got);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    failures += check("compatible", SHADER | GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_HUD,
+                      SHADER | GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_HUD);
+    failures += check("threads alone", SHADER | GLWALL_FEATURE_RENDER_THREADS,
+                      SHADER | GLWALL_FEATURE_RENDER_THREADS);
+
+    failures += check("headless",
+                      GLWALL_FEATURE_HEADLESS | SHADER | GLWALL_FEATURE_TILE |
+                          GLWALL_FEATURE_HUD | GLWALL_FEATURE_RENDER_THREADS |
+                          GLWALL_FEATURE_KEYFRAME,
+                      GLWALL_FEATURE_HEADLESS | SHADER);
+    failures += check("deep pause",
+                      GLWALL_FEATURE_DEEP_PAUSED | SHADER | GLWALL_FEATURE_CHECKERBOARD |
+                          GLWALL_FEATURE_DYNRES,
+                      GLWALL_FEATURE_DEEP_PAUSED | SHADER | GLWALL_FEATURE_DYNRES);
+
+    failures += check("particle on fragment shader",
+                      SHADER | GLWALL_FEATURE_PARTICLE | GLWALL_FEATURE_TILE,
+                      SHADER | GLWALL_FEATURE_TILE);
+    failures += check("particle on vertex shader",
+                      VERTEX_SHADER | GLWALL_FEATURE_PARTICLE | GLWALL_FEATURE_RENDER_THREADS,
+                      VERTEX_SHADER | GLWALL_FEATURE_PARTICLE);
+
+    failures += check("vertex budget on fragment shader",
+                      SHADER | GLWALL_FEATURE_VERTEX_BUDGET | GLWALL_FEATURE_DYNRES,
+                      SHADER | GLWALL_FEATURE_DYNRES);
+    failures += check("vertex budget wins",
+                      VERTEX_SHADER | GLWALL_FEATURE_VERTEX_BUDGET | GLWALL_FEATURE_DYNRES |
+                          GLWALL_FEATURE_COOPERATIVE,
+                      VERTEX_SHADER | GLWALL_FEATURE_VERTEX_BUDGET);
+
+    failures += check("keyframe dropped", SHADER | GLWALL_FEATURE_KEYFRAME | GLWALL_FEATURE_DYNRES,
+                      SHADER | GLWALL_FEATURE_DYNRES);
+    failures += check("keyframe wins",
+                      SHADER | GLWALL_FEATURE_KEYFRAME | GLWALL_FEATURE_COOPERATIVE |
+                          GLWALL_FEATURE_RENDER_THREADS,
+                      SHADER | GLWALL_FEATURE_KEYFRAME);
+
+    failures += check("threads yield to hud",
+                      SHADER | GLWALL_FEATURE_RENDER_THREADS | GLWALL_FEATURE_HUD,
+                      SHADER | GLWALL_FEATURE_HUD);
+    failures += check("threads need a plain shader",
+                      SHADER | GLWALL_FEATURE_PRESET | GLWALL_FEATURE_RENDER_THREADS,
+                      SHADER | GLWALL_FEATURE_PRESET);
+    failures += check("cooperative yields to dynres",
+                      SHADER | GLWALL_FEATURE_COOPERATIVE | GLWALL_FEATURE_DYNRES,
+                      SHADER | GLWALL_FEATURE_DYNRES);
+
+    failures += check("checkerboard on preset",
+                      SHADER | GLWALL_FEATURE_PRESET | GLWALL_FEATURE_CHECKERBOARD,
+                      SHADER | GLWALL_FEATURE_PRESET);
+    failures += check("checkerboard without shader",
+                      SHADER | GLWALL_FEATURE_NO_SHADER | GLWALL_FEATURE_CHECKERBOARD |
+                          GLWALL_FEATURE_TILE,
+                      SHADER | GLWALL_FEATURE_NO_SHADER);
+    failures += check("tile wins",
+                      SHADER | GLWALL_FEATURE_TILE | GLWALL_FEATURE_CHECKERBOARD |
+                          GLWALL_FEATURE_DYNRES | GLWALL_FEATURE_HUD,
+                      SHADER | GLWALL_FEATURE_TILE);
+    failures += check("checkerboard beats dynres",
+                      SHADER | GLWALL_FEATURE_CHECKERBOARD | GLWALL_FEATURE_DYNRES,
+                      SHADER | GLWALL_FEATURE_CHECKERBOARD);
+
+    for (int i = 0; i < feature_compat_rule_count(); i++) {
+        const char *message = feature_compat_rule_message(i);
+        if (!message || message[0] != '-') {
+            fprintf(stderr, "rule %d: missing message\n", i);
+            failures++;
+        }
+    }
+    if (feature_compat_rule_count() > 32) {
+        fprintf(stderr, "%d rules do not fit the fired mask\n", feature_compat_rule_count());
+        failures++;
+    }
+
+    if (failures) {
+        fprintf(stderr, "feature_compat: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("feature_compat: PASS\n");
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../src/frame_stats.h"
+
+#define REFRESH_NS 16666667u
+
+int main(void) {
+    struct glwall_frame_stats st;
+    frame_stats_reset(&st);
+
+    uint64_t t = 1000000000ULL;
+    for (uint64_t seq = 100; seq < 400; seq++) {
+        frame_stats_presented(&st, t, seq, true, REFRESH_NS, t - 4000000ULL, 1);
+        t += REFRESH_NS;
+    }
+    if (st.presented != 300 || st.missed_vblanks != 0) {
+        fprintf(stderr, "steady: presented %llu missed %llu\n", (unsigned long long)st.presented,
+                (unsigned long long)st.missed_vblanks);
+        return 1;
+    }
+    if (fabs(st.latency_avg_ms - 4.0) > 0.01 || st.jitter_avg_ms > 0.01) {
+        fprintf(stderr, "steady: latency %.3f jitter %.3f\n", st.latency_avg_ms,
+                st.jitter_avg_ms);
+        return 1;
+    }
+
+    t += 2 * REFRESH_NS;
+    frame_stats_presented(&st, t, 402, true, REFRESH_NS, t - 4000000ULL, 1);
+    if (st.missed_vblanks != 2 || st.jitter_avg_ms <= 0.0) {
+        fprintf(stderr, "slip: missed %llu jitter %.3f\n", (unsigned long long)st.missed_vblanks,
+                st.jitter_avg_ms);
+        return 1;
+    }
+
+    frame_stats_reset(&st);
+    t = 1000000000ULL;
+    for (int i = 0; i < 10; i++) {
+        frame_stats_presented(&st, t, 0, false, REFRESH_NS, t - 1000000ULL, 2);
+        t += 2 * REFRESH_NS;
+    }
+    t += 2 * REFRESH_NS;
+    frame_stats_presented(&st, t, 0, false, REFRESH_NS, t - 1000000ULL, 2);
+    frame_stats_discarded(&st);
+    if (st.missed_vblanks != 2 || st.discarded != 1) {
+        fprintf(stderr, "half rate: missed %llu discarded %llu\n",
+                (unsigned long long)st.missed_vblanks, (unsigned long long)st.discarded);
+        return 1;
+    }
+
+    printf("frame_stats: PASS\n");
+    return 0;
+}
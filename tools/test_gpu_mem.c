@@ -0,0 +1,56 @@
+#include <stdio.h>
+
+#include "../src/gpu_mem.h"
+
+static int check(const char *what, unsigned long long got, unsigned long long want) {
+    if (got == want)
+        return 0;
+    fprintf(stderr, "%s: expected %llu, got %llu\n", what, want, got);
+    return 1;
+}
+
+int main(void) {
+    struct glwall_gpu_mem mem = {0};
+    int failures = 0;
+
+    gpu_mem_record(&mem, GLWALL_GPU_MEM_TEXTURE, 1, GLWALL_GPU_MEM_LUT, 0, 100);
+    if (!gpu_mem_init(&mem)) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+    failures += check("before init", mem.total_bytes, 0);
+
+    gpu_mem_record(&mem, GLWALL_GPU_MEM_TEXTURE, 1, GLWALL_GPU_MEM_PASS_TARGET, 0, 1000);
+    gpu_mem_record(&mem, GLWALL_GPU_MEM_BUFFER, 1, GLWALL_GPU_MEM_UBO, 0, 48);
+    gpu_mem_record(&mem, GLWALL_GPU_MEM_TEXTURE, 2, GLWALL_GPU_MEM_RENDER_TARGET, 7, 4000);
+    failures += check("total", mem.total_bytes, 5048);
+    failures += check("texture and buffer names are distinct",
+                      gpu_mem_category_usage(&mem, GLWALL_GPU_MEM_UBO).bytes, 48);
+    failures += check("owner 7", gpu_mem_owner_usage(&mem, 7).bytes, 4000);
+    failures += check("shared", gpu_mem_owner_usage(&mem, GLWALL_GPU_MEM_SHARED).bytes, 1048);
+
+    gpu_mem_record(&mem, GLWALL_GPU_MEM_TEXTURE, 2, GLWALL_GPU_MEM_RENDER_TARGET, 7, 1000);
+    failures += check("resized total", mem.total_bytes, 2048);
+    failures += check("peak", mem.peak_bytes, 5048);
+    failures += check("render target objects",
+                      gpu_mem_category_usage(&mem, GLWALL_GPU_MEM_RENDER_TARGET).objects, 1);
+
+    gpu_mem_release(&mem, GLWALL_GPU_MEM_TEXTURE, 1);
+    gpu_mem_release(&mem, GLWALL_GPU_MEM_TEXTURE, 99);
+    failures += check("released", mem.total_bytes, 1048);
+    failures += check("pass targets",
+                      gpu_mem_category_usage(&mem, GLWALL_GPU_MEM_PASS_TARGET).objects, 0);
+
+    for (uint32_t name = 100; name < 300; name++)
+        gpu_mem_record(&mem, GLWALL_GPU_MEM_BUFFER, name, GLWALL_GPU_MEM_PARTICLES, 3, 16);
+    failures += check("many objects", gpu_mem_owner_usage(&mem, 3).bytes, 200 * 16);
+    for (uint32_t name = 100; name < 300; name++)
+        gpu_mem_release(&mem, GLWALL_GPU_MEM_BUFFER, name);
+    failures += check("all released", mem.total_bytes, 1048);
+
+    gpu_mem_cleanup(&mem);
+    if (failures)
+        return 1;
+    printf("gpu_mem: PASS\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/hud_canvas.h"
+
+#define W 64
+#define H 32
+
+static int count_color(const struct glwall_hud_canvas *c, uint8_t color) {
+    int n = 0;
+    for (int i = 0; i < c->width * c->height; i++)
+        n += c->pixels[i] == color;
+    return n;
+}
+
+int main(void) {
+    uint8_t pixels[W * H];
+    struct glwall_hud_canvas canvas = {pixels, W, H};
+
+    hud_canvas_clear(&canvas);
+    int32_t end = hud_canvas_text(&canvas, 1, 1, "1", GLWALL_HUD_TEXT);
+    if (end != 1 + GLWALL_HUD_ADVANCE || count_color(&canvas, GLWALL_HUD_TEXT) != 10) {
+        fprintf(stderr, "glyph: end %d lit %d\n", end, count_color(&canvas, GLWALL_HUD_TEXT));
+        return 1;
+    }
+
+    uint8_t upper[W * H];
+    hud_canvas_clear(&canvas);
+    hud_canvas_text(&canvas, 0, 0, "GPU~", GLWALL_HUD_TEXT);
+    memcpy(upper, pixels, sizeof(upper));
+    hud_canvas_clear(&canvas);
+    end = hud_canvas_text(&canvas, 0, 0, "gpu~", GLWALL_HUD_TEXT);
+    if (memcmp(upper, pixels, sizeof(upper)) != 0 || end != 4 * GLWALL_HUD_ADVANCE) {
+        fprintf(stderr, "case folding or advance mismatch\n");
+        return 1;
+    }
+
+    hud_canvas_clear(&canvas);
+    hud_canvas_text(&canvas, W - 3, H - 3, "88888888", GLWALL_HUD_TEXT);
+    hud_canvas_text(&canvas, -4, -4, "8", GLWALL_HUD_TEXT);
+
+    struct glwall_hud_series series = {0};
+    hud_series_add(&series, 5.0f);
+    hud_series_add(&series, 10.0f);
+    hud_canvas_clear(&canvas);
+    hud_canvas_graph(&canvas, 0, 0, 8, 10, &series, 10.0f, GLWALL_HUD_CPU);
+    if (pixels[0 * W + 7] != GLWALL_HUD_CPU || pixels[9 * W + 7] != GLWALL_HUD_CPU ||
+        pixels[4 * W + 6] != GLWALL_HUD_BACKGROUND || pixels[5 * W + 6] != GLWALL_HUD_CPU ||
+        count_color(&canvas, GLWALL_HUD_CPU) != 15) {
+        fprintf(stderr, "graph: %d bar pixels\n", count_color(&canvas, GLWALL_HUD_CPU));
+        return 1;
+    }
+
+    for (int i = 0; i < GLWALL_HUD_HISTORY + 10; i++)
+        hud_series_add(&series, (float)i);
+    int newest = (series.head - 1 + GLWALL_HUD_HISTORY) % GLWALL_HUD_HISTORY;
+    if (series.count != GLWALL_HUD_HISTORY ||
+        series.values[newest] != (float)(GLWALL_HUD_HISTORY + 9)) {
+        fprintf(stderr, "series: count %d newest %.1f\n", series.count, series.values[newest]);
+        return 1;
+    }
+
+    struct glwall_hud_history history = {0};
+    for (int i = 0; i < 200; i++)
+        hud_history_frame(&history, 1000000000ULL + (uint64_t)i * 16666667ULL, 2.0);
+    if (fabs(history.fps - 60.0) > 0.01 || fabs(history.cpu_ms.avg - 2.0) > 1e-6) {
+        fprintf(stderr, "history: fps %.3f cpu %.3f\n", history.fps, history.cpu_ms.avg);
+        return 1;
+    }
+
+    printf("hud canvas: PASS\n");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "../src/seqlock.h"
+
+#define VALUES 257
+#define WRITES 200000
+
+struct value {
+    uint32_t counter;
+    uint32_t words[VALUES];
+    uint8_t tail[3];
+};
+
+static struct glwall_seqlock lock;
+static atomic_bool done;
+
+static bool consistent(const struct value *v) {
+    for (int i = 0; i < VALUES; i++) {
+        if (v->words[i] != v->counter * 31u + (uint32_t)i)
+            return false;
+    }
+    return v->tail[2] == (uint8_t)v->counter;
+}
+
+static void *reader(void *data) {
+    int *torn = data;
+    struct value v;
+    unsigned last = 0;
+    while (!atomic_load(&done)) {
+        unsigned seq = seqlock_read(&lock, &v);
+        if (seq < last || (seq > 0 && !consistent(&v)))
+            (*torn)++;
+        last = seq;
+    }
+    return NULL;
+}
+
+int main(void) {
+    if (!seqlock_init(&lock, sizeof(struct value))) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    struct value v = {0};
+    if (seqlock_read(&lock, &v) != 0) {
+        fprintf(stderr, "unwritten lock has a nonzero sequence\n");
+        return 1;
+    }
+
+    pthread_t threads[3];
+    int torn[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++)
+        pthread_create(&threads[i], NULL, reader, &torn[i]);
+    for (uint32_t n = 1; n <= WRITES; n++) {
+        v.counter = n;
+        for (int i = 0; i < VALUES; i++)
+            v.words[i] = n * 31u + (uint32_t)i;
+        v.tail[2] = (uint8_t)n;
+        seqlock_write(&lock, &v);
+    }
+    atomic_store(&done, true);
+    for (int i = 0; i < 3; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < 3; i++) {
+        if (torn[i] != 0) {
+            fprintf(stderr, "reader %d saw %d torn or reordered values\n", i, torn[i]);
+            return 1;
+        }
+    }
+
+    struct value last;
+    if (seqlock_read(&lock, &last) != WRITES || last.counter != WRITES || !consistent(&last)) {
+        fprintf(stderr, "final value: counter %u\n", last.counter);
+        return 1;
+    }
+
+    seqlock_destroy(&lock);
+    printf("seqlock: PASS\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/slang_process.h"
+
+static const char *shader_src =
+    "#version 450\n"
+    "layout(push_constant) uniform Push {\n"
+    "    vec4 SourceSize;\n"
+    "    float BLUR_RADIUS;\n"
+    "} params;\n"
+    "layout(std140, set = 0, binding = 0) uniform UBO {\n"
+    "    mat4 MVP;\n"
+    "} global;\n"
+    "#pragma stage vertex\n"
+    "layout(location = 0) in vec4 Position;\n"
+    "layout(location = 1) in vec2 TexCoord;\n"
+    "layout(location = 0) out vec2 vTexCoord;\n"
+    "layout(location = 1) out vec4 offsets;\n"
+    "void main() {\n"
+    "    gl_Position = global.MVP * Position;\n"
+    "    vTexCoord = TexCoord;\n"
+    "    offsets = vec4(params.SourceSize.zw * params.BLUR_RADIUS, 0.0, 0.0);\n"
+    "}\n"
+    "#pragma stage fragment\n"
+    "layout(location = 0) in vec2 vTexCoord;\n"
+    "layout(location = 1) in vec4 offsets;\n"
+    "layout(location = 0) out vec4 FragColor;\n"
+    "layout(set = 0, binding = 2) uniform sampler2D Source;\n"
+    "void main() {\n"
+    "    FragColor = texture(Source, vTexCoord + offsets.xy);\n"
+    "}\n";
+
+static int expect(const char *label, const char *haystack, const char *needle, int present) {
+    int found = strstr(haystack, needle) != NULL;
+    if (found != present) {
+        fprintf(stderr, "%s: expected '%s' to be %s\n%s\n", label, needle,
+                present ? "present" : "absent", haystack);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    char *vs = slang_process_vertex_to_gl330(shader_src);
+    if (!vs) {
+        fprintf(stderr, "Vertex stage not extracted\n");
+        return 1;
+    }
+
+    int failures = 0;
+    failures += expect("vertex", vs, "in vec4 Position", 0);
+    failures += expect("vertex", vs, "in vec2 TexCoord", 0);
+    failures += expect("vertex", vs, "out vec2 vTexCoord;", 1);
+    failures += expect("vertex", vs, "out vec4 offsets;", 1);
+    failures += expect("vertex", vs, "layout(location = 1) out", 0);
+    failures += expect("vertex", vs, "uniform mat4 MVP;", 1);
+    failures += expect("vertex", vs, "gl_Position = MVP * Position;", 1);
+    failures += expect("vertex", vs, "SourceSize.zw * BLUR_RADIUS", 1);
+    failures += expect("vertex", vs, "FragColor", 0);
+
+    char *fs = slang_process_to_gl330(shader_src);
+    if (!fs) {
+        fprintf(stderr, "Fragment stage not extracted\n");
+        free(vs);
+        return 1;
+    }
+    failures += expect("fragment", fs, "in vec4 offsets;", 1);
+    failures += expect("fragment", fs, "in vec2 vTexCoord", 0);
+    failures += expect("fragment", fs, "gl_Position", 0);
+    failures += expect("fragment", fs, "uniform sampler2D Source;", 0);
+
+    char *none = slang_process_vertex_to_gl330("void main() { FragColor = vec4(1.0); }\n");
+    if (none) {
+        fprintf(stderr, "Expected no vertex stage for single-stage source\n");
+        free(none);
+        failures++;
+    }
+
+    free(vs);
+    free(fs);
+
+    if (failures) {
+        fprintf(stderr, "Slang vertex stage tests: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("Slang vertex stage tests: PASS\n");
+    return 0;
+}
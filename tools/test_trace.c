@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/trace.h"
+
+#define TRACE_PATH "/tmp/glwall_test_trace.bin"
+
+static void make_frame(struct glwall_trace_frame *f, int i) {
+    memset(f, 0, sizeof(*f));
+    f->time_sec = (float)i / 60.0f;
+    f->dt_sec = 1.0f / 60.0f;
+    f->frame = i + 1;
+    f->pointer_output = i % 2 ? 1 : -1;
+    f->pointer_x = 10.5 * i;
+    f->pointer_y = 1080.25 - i;
+    f->pointer_down = i == 1;
+    f->pointer_down_x = 3.0;
+    f->pointer_down_y = 4.0;
+    f->pointer_global = i == 2;
+    f->has_audio = i != 0;
+    for (int s = 0; s < GLWALL_TRACE_AUDIO_SAMPLES && f->has_audio; s++)
+        f->audio[s] = (int16_t)((s * 37 + i) % 65536 - 32768);
+}
+
+int main(void) {
+    struct glwall_trace trace;
+    struct glwall_trace_frame want, got;
+
+    if (!trace_open_write(&trace, TRACE_PATH)) {
+        fprintf(stderr, "unable to create %s\n", TRACE_PATH);
+        return 1;
+    }
+    for (int i = 0; i < 3; i++) {
+        make_frame(&want, i);
+        if (!trace_write_frame(&trace, &want))
+            return 1;
+    }
+    if (!trace_close(&trace))
+        return 1;
+
+    if (!trace_open_read(&trace, TRACE_PATH))
+        return 1;
+    for (int i = 0; i < 3; i++) {
+        make_frame(&want, i);
+        memset(&got, 0, sizeof(got));
+        if (!trace_read_frame(&trace, &got) || memcmp(&want, &got, sizeof(want)) != 0) {
+            fprintf(stderr, "frame %d does not round-trip\n", i);
+            return 1;
+        }
+    }
+    if (trace_read_frame(&trace, &got) || trace.error) {
+        fprintf(stderr, "expected clean end of file\n");
+        return 1;
+    }
+    trace_close(&trace);
+
+    FILE *fp = fopen(TRACE_PATH, "r+b");
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    if (truncate(TRACE_PATH, size - 5) != 0)
+        return 1;
+    trace_open_read(&trace, TRACE_PATH);
+    int frames = 0;
+    while (trace_read_frame(&trace, &got))
+        frames++;
+    if (frames != 2 || !trace.error) {
+        fprintf(stderr, "truncated trace: %d frames, error %d\n", frames, trace.error);
+        return 1;
+    }
+    trace_close(&trace);
+
+    fp = fopen(TRACE_PATH, "wb");
+    fputs("NOTATRACE.......", fp);
+    fclose(fp);
+    if (trace_open_read(&trace, TRACE_PATH)) {
+        fprintf(stderr, "bad magic accepted\n");
+        return 1;
+    }
+    remove(TRACE_PATH);
+
+    printf("trace: PASS\n");
+    return 0;
+}
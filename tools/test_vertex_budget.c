@@ -0,0 +1,59 @@
+#include <stdio.h>
+
+#include "../src/vertex_budget.h"
+
+static double frame_cost_ms(double ms_per_million, int32_t count) {
+    return 0.2 + ms_per_million * (double)count / 1e6;
+}
+
+static void run_frames(struct glwall_vertex_budget *vb, double ms_per_million, int frames,
+                       int *changes) {
+    for (int i = 0; i < frames; i++) {
+        if (vertex_budget_update(vb, frame_cost_ms(ms_per_million, vb->count)))
+            (*changes)++;
+    }
+}
+
+int main(void) {
+    struct glwall_vertex_budget vb;
+    int changes = 0;
+
+    vertex_budget_init(&vb, 4.0f, 4096, 262144);
+    run_frames(&vb, 4.0, 600, &changes);
+    if (vb.count != 262144 || changes != 0) {
+        fprintf(stderr, "cheap vertices: expected full count, got %d (%d changes)\n", vb.count,
+                changes);
+        return 1;
+    }
+
+    changes = 0;
+    run_frames(&vb, 40.0, 600, &changes);
+    double cost = frame_cost_ms(40.0, vb.count);
+    if (vb.count >= 262144 || cost > 4.0 * 1.10 || vb.count % 64 != 0) {
+        fprintf(stderr, "expensive vertices: count %d cost %.3f ms over budget\n", vb.count, cost);
+        return 1;
+    }
+    int settle_changes = changes;
+    changes = 0;
+    run_frames(&vb, 40.0, 1200, &changes);
+    if (changes > 1) {
+        fprintf(stderr, "expensive vertices: oscillated (%d changes after settling %d)\n", changes,
+                settle_changes);
+        return 1;
+    }
+
+    run_frames(&vb, 10000.0, 600, &changes);
+    if (vb.count != 4096) {
+        fprintf(stderr, "overloaded GPU: expected min count, got %d\n", vb.count);
+        return 1;
+    }
+
+    run_frames(&vb, 1.0, 3000, &changes);
+    if (vb.count != 262144) {
+        fprintf(stderr, "recovered GPU: expected full count, got %d\n", vb.count);
+        return 1;
+    }
+
+    printf("vertex budget controller: PASS\n");
+    return 0;
+}